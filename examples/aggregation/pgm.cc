@@ -0,0 +1,153 @@
+/* charmlite aggregation benchmark
+ *
+ * each element of an array sends a burst of messages to the others,
+ * either directly or aggregated, for a range of message sizes. the
+ * rates show where aggregation stops paying off (i.e., the crossover)
+ */
+
+#include <cmk.hh>
+
+using payload_message_t = cmk::array_message<char>;
+
+struct round_params
+{
+    int nElts;
+    int nMsgs;
+    std::size_t size;
+    bool aggregate;
+};
+
+using round_message_t = cmk::data_message<round_params>;
+
+void round_completed_(cmk::message_ptr<>&& msg);
+
+// a chare that uses an int for its index
+struct member : public cmk::chare<member, int>
+{
+    int nExpected;
+    int nReceived;
+
+    member(void)
+      : nExpected(0)
+      , nReceived(0)
+    {
+    }
+
+    void run(cmk::message_ptr<round_message_t>&& msg)
+    {
+        auto& params = msg->value();
+        this->nExpected = params.nMsgs;
+        auto col = cmk::collection_proxy<member>(this->collection());
+        auto self = this->index();
+        // (every element is sent one message per step, by a different one)
+        auto nOthers = std::max(params.nElts - 1, 1);
+        for (int k = 0; k < params.nMsgs; k++)
+        {
+            auto to = (self + 1 + (k % nOthers)) % params.nElts;
+            auto out = payload_message_t::make(params.size, (char) k);
+            if (params.aggregate)
+            {
+                col[to].send_aggregated<payload_message_t, &member::receive>(
+                    std::move(out));
+            }
+            else
+            {
+                col[to].send<payload_message_t, &member::receive>(
+                    std::move(out));
+            }
+        }
+        // ( otherwise, they're flushed once the scheduler gets to it )
+        if (params.aggregate)
+        {
+            cmk::flush_aggregates();
+        }
+        this->try_finish_();
+    }
+
+    void receive(cmk::message_ptr<payload_message_t>&& msg)
+    {
+        this->nReceived++;
+        this->try_finish_();
+    }
+
+private:
+    void try_finish_(void)
+    {
+        // (messages can arrive before this round starts here)
+        if ((this->nExpected > 0) && (this->nReceived == this->nExpected))
+        {
+            this->nExpected = this->nReceived = 0;
+            auto cb =
+                cmk::callback<cmk::message>::construct<round_completed_>(0);
+            this->element_proxy().contribute<cmk::message, cmk::nop>(
+                cmk::make_message<cmk::message>(), cb);
+        }
+    }
+};
+
+CthThread th;
+
+void round_completed_(cmk::message_ptr<>&& msg)
+{
+    CthAwaken(th);
+}
+
+// returns the rate (in messages per second, over the whole array)
+double measure(const cmk::collection_proxy<member>& arr,
+    const round_params& params, std::size_t nIts)
+{
+    double startTime;
+    // the first (few) rounds are a warm up
+    for (std::size_t it = 0; it < (nIts + 2); it++)
+    {
+        if (it == 2)
+        {
+            startTime = CmiWallTimer();
+        }
+        arr.broadcast<round_message_t, &member::run>(
+            cmk::make_message<round_message_t>(params));
+        CthSuspend();
+    }
+    auto elapsed = CmiWallTimer() - startTime;
+    return ((double) nIts * params.nElts * params.nMsgs) / elapsed;
+}
+
+int main(int argc, char** argv)
+{
+    cmk::initialize(argc, argv);
+    if (CmiMyNode() == 0)
+    {
+        th = CthSelf();
+        CmiAssert(th && CthIsSuspendable(th));
+        std::size_t nIts = (argc >= 2) ? atoll(argv[1]) : 16;
+        int nMsgs = (argc >= 3) ? atoi(argv[2]) : 1024;
+        int nElts = (argc >= 4) ? atoi(argv[3]) : (2 * CmiNumPes());
+        cmk::collection_options<int> opts(nElts);
+        auto arr = cmk::collection_proxy<member>::construct(opts);
+        CmiPrintf("main> %d elements sending %d messages each\n", nElts, nMsgs);
+        CmiPrintf("main> size (B)\tdirect (msg/s)\taggregated (msg/s)\n");
+        auto crossover = std::size_t(0);
+        for (std::size_t size = 8; size <= (1 << 14); size *= 4)
+        {
+            auto direct = measure(arr, {nElts, nMsgs, size, false}, nIts);
+            auto aggregated = measure(arr, {nElts, nMsgs, size, true}, nIts);
+            CmiPrintf("main> %zu\t\t%.4g\t\t%.4g\n", size, direct, aggregated);
+            if ((crossover == 0) && (direct >= aggregated))
+            {
+                crossover = size;
+            }
+        }
+        if (crossover == 0)
+        {
+            CmiPrintf("main> aggregation helped at every size\n");
+        }
+        else
+        {
+            CmiPrintf("main> aggregation stops helping around %zu bytes\n",
+                crossover);
+        }
+        cmk::exit();
+    }
+    cmk::finalize();
+    return 0;
+}
@@ -0,0 +1,152 @@
+/* charmlite all-to-all benchmark
+ *
+ * each element of an array sends every element a few values, either
+ * through an all-to-all or through point-to-point sends, and checks the
+ * values it receives
+ */
+
+#include <cmk.hh>
+
+using array_message_t = cmk::array_message<int>;
+using gather_message_t = cmk::gather_message<int>;
+// the number of elements, and whether to use all-to-alls
+using round_message_t = cmk::data_message<std::pair<int, bool>>;
+
+constexpr std::size_t nValues = 4;
+
+void round_completed_(cmk::message_ptr<>&& msg);
+
+int value_for_(int from, int to)
+{
+    return (from << 16) | to;
+}
+
+// a chare that uses an int for its index
+struct member : public cmk::chare<member, int>
+{
+    int nElts;
+    int nReceived;
+
+    member(void)
+      : nElts(0)
+      , nReceived(0)
+    {
+    }
+
+    void run(cmk::message_ptr<round_message_t>&& msg)
+    {
+        this->nElts = msg->value().first;
+        auto self = this->index();
+        if (msg->value().second)
+        {
+            auto out = gather_message_t::make(
+                this->nElts, this->nElts * nValues);
+            std::array<int, nValues> vals;
+            for (int to = 0; to < this->nElts; to++)
+            {
+                vals.fill(value_for_(self, to));
+                out->append(to, vals.data(), nValues);
+            }
+            this->element_proxy()
+                .all_to_all<int, &member::receive_all>(std::move(out));
+        }
+        else
+        {
+            auto col = cmk::collection_proxy<member>(this->collection());
+            for (int to = 0; to < this->nElts; to++)
+            {
+                auto out = array_message_t::make(
+                    nValues, value_for_(self, to));
+                col[to].send<array_message_t, &member::receive>(
+                    std::move(out));
+            }
+        }
+    }
+
+    void receive_all(cmk::message_ptr<gather_message_t>&& msg)
+    {
+        CmiEnforceMsg(msg->size() == (std::size_t) this->nElts,
+            "unexpected number of sources");
+        for (std::size_t i = 0; i < msg->size(); i++)
+        {
+            auto from = msg->index<int>(i);
+            CmiEnforceMsg(from == (int) i, "sources out of order");
+            this->check_(from, msg->values(i), msg->count(i));
+        }
+        this->done_();
+    }
+
+    void receive(cmk::message_ptr<array_message_t>&& msg)
+    {
+        // ( the sender is encoded in the values )
+        this->check_((*msg)[0] >> 16, msg->data(), msg->size());
+        if (++(this->nReceived) == this->nElts)
+        {
+            this->nReceived = 0;
+            this->done_();
+        }
+    }
+
+private:
+    void check_(int from, const int* vals, std::size_t n)
+    {
+        CmiEnforceMsg(n == nValues, "unexpected number of values");
+        for (std::size_t i = 0; i < n; i++)
+        {
+            CmiEnforceMsg(vals[i] == value_for_(from, this->index()),
+                "unexpected value");
+        }
+    }
+
+    void done_(void)
+    {
+        auto cb = cmk::callback<cmk::message>::construct<round_completed_>(0);
+        this->element_proxy().contribute<cmk::message, cmk::nop>(
+            cmk::make_message<cmk::message>(), cb);
+    }
+};
+
+CthThread th;
+
+void round_completed_(cmk::message_ptr<>&& msg)
+{
+    CthAwaken(th);
+}
+
+double measure(const cmk::collection_proxy<member>& arr, int nElts,
+    bool all_to_all, std::size_t nIts)
+{
+    double startTime;
+    // the first (few) rounds are a warm up
+    for (std::size_t it = 0; it < (nIts + 2); it++)
+    {
+        if (it == 2)
+        {
+            startTime = CmiWallTimer();
+        }
+        arr.broadcast<round_message_t, &member::run>(
+            cmk::make_message<round_message_t>(nElts, all_to_all));
+        CthSuspend();
+    }
+    return (CmiWallTimer() - startTime) / (double) nIts;
+}
+
+int main(int argc, char** argv)
+{
+    cmk::initialize(argc, argv);
+    if (CmiMyNode() == 0)
+    {
+        th = CthSelf();
+        CmiAssert(th && CthIsSuspendable(th));
+        std::size_t nIts = (argc >= 2) ? atoll(argv[1]) : 64;
+        int nElts = (argc >= 3) ? atoi(argv[2]) : (8 * CmiNumPes());
+        cmk::collection_options<int> opts(nElts);
+        auto arr = cmk::collection_proxy<member>::construct(opts);
+        CmiPrintf("main> array of %d: %g us/all-to-all, %g us/round of sends\n",
+            nElts, 1e6 * measure(arr, nElts, true, nIts),
+            1e6 * measure(arr, nElts, false, nIts));
+        cmk::exit();
+    }
+    cmk::finalize();
+    return 0;
+}
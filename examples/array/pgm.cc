@@ -0,0 +1,48 @@
+/* charmlite chare-array collectives demo
+ *
+ * broadcasts to, then reduces over, an array
+ * whose elements are spread across all pes
+ */
+
+#include <cmk.hh>
+
+using int_message = cmk::data_message<int>;
+
+void print_sum_(cmk::message_ptr<int_message>&& msg)
+{
+    CmiPrintf("main> sum of contributions was %d\n", msg->value());
+    cmk::exit();
+}
+
+// a chare that uses an int for its index
+struct element : public cmk::chare<element, int>
+{
+    element(void) = default;
+
+    void contribute(cmk::message_ptr<const int_message>&& msg)
+    {
+        // every element receives the same (shared) message
+        auto val = msg->value() * this->index();
+        auto cb = cmk::callback<int_message>::construct<print_sum_>(0);
+        this->element_proxy().contribute<int_message, cmk::add<int>>(
+            cmk::make_message<int_message>(val), cb);
+    }
+};
+
+int main(int argc, char** argv)
+{
+    cmk::initialize(argc, argv);
+    if (CmiMyNode() == 0)
+    {
+        int n = (argc >= 2) ? atoi(argv[1]) : (4 * CmiNumPes());
+        CmiPrintf("main> expecting a sum of %d\n", n * (n - 1));
+        // create an array with n elements
+        auto arr = cmk::collection_proxy<element>::construct(
+            cmk::collection_options<int>(n));
+        // then ask them all to contribute
+        arr.broadcast<const int_message, &element::contribute>(
+            cmk::make_message<int_message>(2));
+    }
+    cmk::finalize();
+    return 0;
+}
@@ -0,0 +1,77 @@
+/* charmlite barrier benchmark
+ *
+ * compares the latency of barriers to that of
+ * nop reductions, over a group and an array
+ */
+
+#include <cmk.hh>
+
+void round_completed_(cmk::message_ptr<>&& msg);
+
+// a chare that uses an int for its index
+struct member : public cmk::chare<member, int>
+{
+    member(void) = default;
+
+    void arrive(cmk::message_ptr<cmk::data_message<bool>>&& msg)
+    {
+        auto cb = cmk::callback<cmk::message>::construct<round_completed_>(0);
+        auto elt = this->element_proxy();
+        if (msg->value())
+        {
+            elt.barrier(cb);
+        }
+        else
+        {
+            elt.contribute<cmk::message, cmk::nop>(
+                cmk::make_message<cmk::message>(), cb);
+        }
+    }
+};
+
+CthThread th;
+
+void round_completed_(cmk::message_ptr<>&& msg)
+{
+    CthAwaken(th);
+}
+
+template <typename Proxy>
+double measure(const Proxy& col, bool barrier, std::size_t nIts)
+{
+    double startTime;
+    // the first (few) rounds are a warm up
+    for (std::size_t it = 0; it < (nIts + 2); it++)
+    {
+        if (it == 2)
+        {
+            startTime = CmiWallTimer();
+        }
+        col.template broadcast<cmk::data_message<bool>, &member::arrive>(
+            cmk::make_message<cmk::data_message<bool>>(barrier));
+        CthSuspend();
+    }
+    return (CmiWallTimer() - startTime) / (double) nIts;
+}
+
+int main(int argc, char** argv)
+{
+    cmk::initialize(argc, argv);
+    if (CmiMyNode() == 0)
+    {
+        th = CthSelf();
+        CmiAssert(th && CthIsSuspendable(th));
+        std::size_t nIts = (argc >= 2) ? atoll(argv[1]) : 1024;
+        int nElts = (argc >= 3) ? atoi(argv[2]) : (8 * CmiNumPes());
+        auto grp = cmk::group_proxy<member>::construct();
+        CmiPrintf("main> group: %g us/barrier, %g us/reduction\n",
+            1e6 * measure(grp, true, nIts), 1e6 * measure(grp, false, nIts));
+        cmk::collection_options<int> opts(nElts);
+        auto arr = cmk::collection_proxy<member>::construct(opts);
+        CmiPrintf("main> array of %d: %g us/barrier, %g us/reduction\n", nElts,
+            1e6 * measure(arr, true, nIts), 1e6 * measure(arr, false, nIts));
+        cmk::exit();
+    }
+    cmk::finalize();
+    return 0;
+}
@@ -92,14 +92,11 @@ public:
         else
         {
             // contribute to the all_reduce with other participants
-            auto cb =
-                this->collection_proxy()
-                    .callback<count_message, &completion::receive_count_>();
             auto count = cmk::make_message<count_message>(idx, status.lcount);
             this->element_proxy()
-                .contribute<count_message,
-                    cmk::add<typename count_message::type>>(
-                    std::move(count), cb);
+                .all_reduce<count_message,
+                    cmk::add<typename count_message::type>,
+                    &completion::receive_count_>(std::move(count));
         }
     }
 
@@ -0,0 +1,81 @@
+/* charmlite built-in combiner benchmark
+ *
+ * measures the throughput of the built-in combiners on
+ * (multi-megabyte) arrays, then that of a group-wide sum
+ */
+
+#include <cmk.hh>
+
+using vector_message_t = cmk::array_message<double>;
+
+void reduced_(cmk::message_ptr<vector_message_t>&&);
+
+// a chare that uses an int for its index
+struct member : public cmk::chare<member, int>
+{
+    member(void) = default;
+
+    void run(cmk::message_ptr<cmk::data_message<std::size_t>>&& msg)
+    {
+        auto cb = cmk::callback<vector_message_t>::construct<reduced_>(0);
+        this->element_proxy()
+            .contribute<vector_message_t, cmk::sum<vector_message_t>>(
+                vector_message_t::make(msg->value(), (double) this->index()),
+                cb);
+    }
+};
+
+CthThread th;
+
+void reduced_(cmk::message_ptr<vector_message_t>&& msg)
+{
+    auto expected = (double) (CmiNumPes() * (CmiNumPes() - 1)) / 2.0;
+    auto& last = (*msg)[msg->size() - 1];
+    CmiEnforceMsg(((*msg)[0] == expected) && (last == expected),
+        "unexpected reduction result");
+    CthAwaken(th);
+}
+
+// returns the (local) throughput of a combiner in GB/s
+template <cmk::combiner_fn_t<vector_message_t> Combiner>
+double measure(std::size_t n, std::size_t nIts)
+{
+    auto lhs = vector_message_t::make(n, 1.0);
+    auto startTime = CmiWallTimer();
+    for (std::size_t it = 0; it < nIts; it++)
+    {
+        auto rhs = vector_message_t::make(n, 2.0);
+        lhs = Combiner(std::move(lhs), std::move(rhs));
+    }
+    auto elapsed = CmiWallTimer() - startTime;
+    // each iteration reads both operands and writes one
+    return (3.0 * n * sizeof(double) * nIts) / (elapsed * 1e9);
+}
+
+int main(int argc, char** argv)
+{
+    cmk::initialize(argc, argv);
+    if (CmiMyNode() == 0)
+    {
+        th = CthSelf();
+        CmiAssert(th && CthIsSuspendable(th));
+        std::size_t n = (argc >= 2) ? atoll(argv[1]) : (1 << 20);
+        std::size_t nIts = (argc >= 3) ? atoll(argv[2]) : 64;
+        CmiPrintf("main> sum: %g GB/s\n",
+            measure<cmk::sum<vector_message_t>>(n, nIts));
+        CmiPrintf("main> min: %g GB/s\n",
+            measure<cmk::min<vector_message_t>>(n, nIts));
+        CmiPrintf("main> max: %g GB/s\n",
+            measure<cmk::max<vector_message_t>>(n, nIts));
+        auto grp = cmk::group_proxy<member>::construct();
+        auto startTime = CmiWallTimer();
+        grp.broadcast<cmk::data_message<std::size_t>, &member::run>(
+            cmk::make_message<cmk::data_message<std::size_t>>(n));
+        CthSuspend();
+        CmiPrintf("main> group-wide sum of %zu doubles took %g s\n", n,
+            CmiWallTimer() - startTime);
+        cmk::exit();
+    }
+    cmk::finalize();
+    return 0;
+}
@@ -0,0 +1,91 @@
+/* charmlite gather/scatter demo
+ *
+ * each member of a group contributes (index + 1) copies of its index,
+ * the root checks the gathered values then scatters them back (doubled)
+ */
+
+#include <cmk.hh>
+
+using array_message_t = cmk::array_message<int>;
+using gather_message_t = cmk::gather_message<int>;
+
+void gathered_(cmk::message_ptr<gather_message_t>&&);
+void scattered_(cmk::message_ptr<>&&);
+
+// a chare that uses an int for its index
+struct member : public cmk::chare<member, int>
+{
+    member(void) {}
+
+    void run(cmk::message_ptr<>&&)
+    {
+        auto n = (std::size_t) this->index() + 1;
+        auto cb = cmk::callback<gather_message_t>::construct<gathered_>(0);
+        this->element_proxy().gather(
+            array_message_t::make(n, this->index()), cb);
+    }
+
+    void receive(cmk::message_ptr<array_message_t>&& msg)
+    {
+        CmiEnforceMsg(msg->size() == ((std::size_t) this->index() + 1),
+            "unexpected number of values");
+        for (auto& val : *msg)
+        {
+            CmiEnforceMsg(val == (2 * this->index()), "unexpected value");
+        }
+        CmiPrintf("ch%d@pe%d> received its slice\n", this->index(), CmiMyPe());
+        auto cb = cmk::callback<cmk::message>::construct<scattered_>(0);
+        this->element_proxy().contribute<cmk::message, cmk::nop>(
+            cmk::make_message<cmk::message>(), cb);
+    }
+};
+
+CthThread th;
+cmk::collection_index_t grp_id;
+
+void gathered_(cmk::message_ptr<gather_message_t>&& msg)
+{
+    CmiEnforceMsg(msg->size() == (std::size_t) CmiNumPes(),
+        "unexpected number of entries");
+    for (std::size_t i = 0; i < msg->size(); i++)
+    {
+        auto idx = msg->index<int>(i);
+        CmiEnforceMsg(idx == (int) i, "entries out of order");
+        CmiEnforceMsg(msg->count(i) == (std::size_t) idx + 1,
+            "unexpected number of values");
+        auto* vals = msg->values(i);
+        for (std::size_t j = 0; j < msg->count(i); j++)
+        {
+            CmiEnforceMsg(vals[j] == idx, "unexpected value");
+            vals[j] *= 2;
+        }
+    }
+    CmiPrintf("main> gathered %lu values\n", msg->n_values());
+    // the gathered message can be scattered as-is
+    cmk::group_proxy<member>(grp_id).scatter<int, &member::receive>(
+        std::move(msg));
+}
+
+void scattered_(cmk::message_ptr<>&&)
+{
+    CthAwaken(th);
+}
+
+int main(int argc, char** argv)
+{
+    cmk::initialize(argc, argv);
+    if (CmiMyNode() == 0)
+    {
+        th = CthSelf();
+        CmiAssert(th && CthIsSuspendable(th));
+        auto grp = cmk::group_proxy<member>::construct();
+        grp_id = grp;
+        grp.broadcast<cmk::message, &member::run>(
+            cmk::make_message<cmk::message>());
+        CthSuspend();
+        CmiPrintf("main> gather and scatter complete!\n");
+        cmk::exit();
+    }
+    cmk::finalize();
+    return 0;
+}
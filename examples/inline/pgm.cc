@@ -0,0 +1,99 @@
+/* charmlite local message-rate benchmark
+ *
+ * each element repeatedly messages itself, either
+ * through the scheduler or via inline delivery
+ */
+
+#include <cmk.hh>
+
+void phase_completed_(cmk::message_ptr<cmk::data_message<double>>&&);
+
+// a tuple with (nMsgs, inline?) as its members
+using run_message_t = cmk::data_message<std::tuple<std::size_t, bool>>;
+
+// a chare that uses an int for its index
+struct looper : public cmk::chare<looper, int>
+{
+    std::size_t it, nMsgs;
+    bool inline_;
+    double startTime;
+
+    looper(void) = default;
+
+    void run(cmk::message_ptr<run_message_t>&& msg)
+    {
+        auto& val = msg->value();
+        this->it = 0;
+        this->nMsgs = std::get<0>(val);
+        this->inline_ = std::get<1>(val);
+        cmk::message::free(msg);
+        this->startTime = CmiWallTimer();
+        this->next_(cmk::make_message<cmk::message>());
+    }
+
+    void receive(cmk::message_ptr<>&& msg)
+    {
+        if (++(this->it) == this->nMsgs)
+        {
+            auto endTime = CmiWallTimer();
+            auto cb = cmk::callback<cmk::data_message<double>>::construct<
+                phase_completed_>(0);
+            cb.send(cmk::make_message<cmk::data_message<double>>(
+                endTime - this->startTime));
+        }
+        else
+        {
+            this->next_(std::move(msg));
+        }
+    }
+
+private:
+    void next_(cmk::message_ptr<>&& msg)
+    {
+        auto elt = this->element_proxy();
+        if (this->inline_)
+        {
+            elt.send<cmk::message, &looper::receive, true>(std::move(msg));
+        }
+        else
+        {
+            elt.send<cmk::message, &looper::receive>(std::move(msg));
+        }
+    }
+};
+
+CthThread th;
+double lastTime;
+
+void phase_completed_(cmk::message_ptr<cmk::data_message<double>>&& msg)
+{
+    lastTime = msg->value();
+    CthAwaken(th);
+}
+
+int main(int argc, char** argv)
+{
+    cmk::initialize(argc, argv);
+    if (CmiMyNode() == 0)
+    {
+        th = CthSelf();
+        CmiAssert(th && CthIsSuspendable(th));
+        auto grp = cmk::group_proxy<looper>::construct();
+        std::size_t nMsgs = (argc >= 2) ? atoll(argv[1]) : (1 << 20);
+        for (auto inl : {false, true})
+        {
+            // warm up then measure
+            for (auto i = 0; i < 2; i++)
+            {
+                grp[0].send<run_message_t, &looper::run>(
+                    cmk::make_message<run_message_t>(nMsgs, inl));
+                CthSuspend();
+            }
+            CmiPrintf("main> %s sends: %g messages/s\n",
+                inl ? "inline" : "queued", (double) nMsgs / lastTime);
+        }
+        cmk::exit();
+    }
+    cmk::finalize();
+    return 0;
+}
@@ -0,0 +1,85 @@
+/* charmlite element-lookup microbenchmark
+ *
+ * compares the per-message cost of finding an element
+ * in std::unordered_map versus cmk::flat_map
+ */
+
+#include <cmk.hh>
+
+// mirrors how collections store their elements
+using element_t = cmk::chare_base_*;
+
+struct lcg
+{
+    std::uint64_t state;
+
+    std::uint64_t operator()(void)
+    {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        return state >> 17;
+    }
+};
+
+// returns the average time per lookup (in ns)
+template <typename Map>
+double time_lookups(Map& map, std::size_t n_elts, std::size_t n_lookups)
+{
+    lcg gen{n_elts};
+    std::size_t n_found = 0;
+    auto start = CmiWallTimer();
+    for (std::size_t i = 0; i < n_lookups; i++)
+    {
+        auto idx = cmk::index_view<int>::encode((int) (gen() % n_elts));
+        auto find = map.find(idx);
+        n_found += (find != std::end(map)) && (find->second != nullptr);
+    }
+    auto end = CmiWallTimer();
+    CmiEnforce(n_found == n_lookups);
+    return (1e9 * (end - start)) / (double) n_lookups;
+}
+
+template <typename Map>
+void fill(Map& map, std::size_t n_elts)
+{
+    for (std::size_t i = 0; i < n_elts; i++)
+    {
+        auto idx = cmk::index_view<int>::encode((int) i);
+        map.emplace(idx, reinterpret_cast<element_t>(i + 1));
+    }
+}
+
+void run(std::size_t n_elts, std::size_t n_lookups)
+{
+    double node_time, flat_time;
+    {
+        std::unordered_map<cmk::chare_index_t, element_t,
+            cmk::chare_index_hasher_>
+            map;
+        fill(map, n_elts);
+        node_time = time_lookups(map, n_elts, n_lookups);
+    }
+    {
+        cmk::chare_flat_map_<element_t> map;
+        fill(map, n_elts);
+        flat_time = time_lookups(map, n_elts, n_lookups);
+    }
+    CmiPrintf("main> %lu elements: unordered_map %.2f ns, flat_map %.2f ns "
+              "per lookup\n",
+        n_elts, node_time, flat_time);
+}
+
+int main(int argc, char** argv)
+{
+    cmk::initialize(argc, argv);
+    if (CmiMyNode() == 0)
+    {
+        std::size_t n_lookups = (argc >= 2) ? atoll(argv[1]) : (1 << 22);
+        for (std::size_t n_elts : {1000, 100000, 10000000})
+        {
+            run(n_elts, n_lookups);
+        }
+        cmk::exit();
+    }
+    cmk::finalize();
+    return 0;
+}
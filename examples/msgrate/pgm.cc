@@ -0,0 +1,112 @@
+/* charmlite message-rate benchmark
+ *
+ * one element streams small (8-byte) messages to another, reporting the
+ * size of the message header and the rate the messages arrive at. build
+ * pgm-wide (i.e., with CHARMLITE_COMPACT_HEADER=0) to compare layouts
+ */
+
+#include <cmk.hh>
+
+using payload_message_t = cmk::data_message<double>;
+
+using round_message_t = cmk::data_message<int>;
+
+void round_completed_(cmk::message_ptr<>&& msg);
+
+// a chare that uses an int for its index
+struct streamer : public cmk::chare<streamer, int>
+{
+    int nExpected;
+    int nReceived;
+
+    streamer(void)
+      : nExpected(0)
+      , nReceived(0)
+    {
+    }
+
+    // (element 0 sends, element 1 receives)
+    void run(cmk::message_ptr<round_message_t>&& msg)
+    {
+        auto nMsgs = msg->value();
+        if (this->index() == 0)
+        {
+            auto peer = cmk::collection_proxy<streamer>(this->collection())[1];
+            for (int k = 0; k < nMsgs; k++)
+            {
+                peer.send<payload_message_t, &streamer::receive>(
+                    cmk::make_message<payload_message_t>((double) k));
+            }
+        }
+        else
+        {
+            this->nExpected = nMsgs;
+            this->try_finish_();
+        }
+    }
+
+    void receive(cmk::message_ptr<payload_message_t>&& msg)
+    {
+        this->nReceived++;
+        this->try_finish_();
+    }
+
+private:
+    void try_finish_(void)
+    {
+        // (messages can arrive before this round starts here)
+        if ((this->nExpected > 0) && (this->nReceived == this->nExpected))
+        {
+            this->nExpected = this->nReceived = 0;
+            auto cb =
+                cmk::callback<cmk::message>::construct<round_completed_>(0);
+            cb.send(cmk::make_message<cmk::message>());
+        }
+    }
+};
+
+CthThread th;
+
+void round_completed_(cmk::message_ptr<>&& msg)
+{
+    CthAwaken(th);
+}
+
+int main(int argc, char** argv)
+{
+    cmk::initialize(argc, argv);
+    if (CmiMyNode() == 0)
+    {
+        th = CthSelf();
+        CmiAssert(th && CthIsSuspendable(th));
+        std::size_t nIts = (argc >= 2) ? atoll(argv[1]) : 16;
+        int nMsgs = (argc >= 3) ? atoi(argv[2]) : 65536;
+        CmiPrintf("main> %s header: message=%zuB, destination=%zuB, "
+                  "priority=%zuB\n",
+            CHARMLITE_COMPACT_HEADER ? "compact" : "wide", cmk::header_size,
+            sizeof(cmk::destination), sizeof(cmk::priority));
+        CmiPrintf("main> an 8-byte message takes %zuB\n",
+            sizeof(payload_message_t));
+        // (one element per pe, so the messages cross pes when they can)
+        cmk::collection_options<int> opts(2);
+        auto arr = cmk::collection_proxy<streamer>::construct(opts);
+        double startTime;
+        // the first (few) rounds are a warm up
+        for (std::size_t it = 0; it < (nIts + 2); it++)
+        {
+            if (it == 2)
+            {
+                startTime = CmiWallTimer();
+            }
+            arr.broadcast<round_message_t, &streamer::run>(
+                cmk::make_message<round_message_t>(nMsgs));
+            CthSuspend();
+        }
+        auto elapsed = CmiWallTimer() - startTime;
+        CmiPrintf("main> %zu rounds of %d messages, %.4g msg/s\n", nIts,
+            nMsgs, ((double) nIts * nMsgs) / elapsed);
+        cmk::exit();
+    }
+    cmk::finalize();
+    return 0;
+}
@@ -33,10 +33,14 @@ struct payload_message : public cmk::message
 static_assert(cmk::is_packable<payload_message>::value,
     "expected payload mesasge to be packable");
 
+// references the sender's copy of the payload (instead of carrying it)
+using buffer_message_t = cmk::data_message<cmk::buffer<char>>;
+
 void phase_completed_(cmk::message_ptr<cmk::data_message<double>>&&);
 
-// a tuple with (sz, nIts) as its members
-using run_message_t = cmk::data_message<std::tuple<std::size_t, std::size_t>>;
+// a tuple with (sz, nIts, zeroCopy) as its members
+using run_message_t =
+    cmk::data_message<std::tuple<std::size_t, std::size_t, bool>>;
 
 // a chare that uses an int for its index
 struct pingpong : public cmk::chare<pingpong, int>
@@ -44,39 +48,49 @@ struct pingpong : public cmk::chare<pingpong, int>
     cmk::element_proxy<pingpong> peer;
     std::size_t it, nIts;
     double startTime;
+    // (for zero-copy runs) this element's copy of the payload
+    std::vector<char> local;
+    std::size_t nReleased;
 
     pingpong(void)
       : peer((this->collection_proxy())[(this->index() + 1) % CmiNumPes()])
+      , nReleased(0)
     {
     }
 
     void run(cmk::message_ptr<run_message_t>&& msg)
     {
         auto& val = msg->value();
-        auto& sz = std::get<1>(val);
-        // allocate the payload
-        cmk::message_ptr<payload_message> payload(
-            new (sizeof(cmk::message) + sz) payload_message(sz));
+        auto sz = std::get<0>(val);
+        auto zeroCopy = std::get<2>(val);
         // reset the iteration counts
         this->it = 0;
         this->nIts = std::get<1>(val);
         // free the run-message (since we're done with it)
         cmk::message::free(msg);
-        // then GO!
-        this->startTime = CmiWallTimer();
-        peer.send<payload_message, &pingpong::receive_message>(
-            std::move(payload));
+        if (zeroCopy)
+        {
+            this->local.assign(sz, 'a');
+            this->startTime = CmiWallTimer();
+            this->send_buffer_();
+        }
+        else
+        {
+            // allocate the payload
+            cmk::message_ptr<payload_message> payload(
+                new (sizeof(cmk::message) + sz) payload_message(sz));
+            // then GO!
+            this->startTime = CmiWallTimer();
+            peer.send<payload_message, &pingpong::receive_message>(
+                std::move(payload));
+        }
     }
 
     void receive_message(cmk::message_ptr<payload_message>&& msg)
     {
         if ((this->index() == 0) && (++(this->it) == this->nIts))
         {
-            auto endTime = CmiWallTimer();
-            auto cb = cmk::callback<cmk::data_message<double>>::construct<
-                phase_completed_>(0);
-            cb.send(cmk::make_message<cmk::data_message<double>>(
-                endTime - this->startTime));
+            this->complete_phase_(CmiWallTimer());
         }
         else
         {
@@ -84,6 +98,52 @@ struct pingpong : public cmk::chare<pingpong, int>
                 std::move(msg));
         }
     }
+
+    // copies the peer's payload straight into ours
+    void receive_buffer(cmk::message_ptr<buffer_message_t>&& msg)
+    {
+        auto& buf = msg->value();
+        this->local.resize(buf.size());
+        buf.get(this->local.data(),
+            this->element_proxy()
+                .callback<cmk::message, &pingpong::fetched_buffer>());
+    }
+
+    void fetched_buffer(cmk::message_ptr<>&&)
+    {
+        if ((this->index() == 0) && (++(this->it) == this->nIts))
+        {
+            this->complete_phase_(CmiWallTimer());
+        }
+        else
+        {
+            this->send_buffer_();
+        }
+    }
+
+    // invoked once the peer no longer needs our payload
+    void released_buffer(cmk::message_ptr<>&&)
+    {
+        this->nReleased++;
+    }
+
+private:
+    void send_buffer_(void)
+    {
+        auto done = this->element_proxy()
+                        .callback<cmk::message, &pingpong::released_buffer>();
+        peer.send<buffer_message_t, &pingpong::receive_buffer>(
+            cmk::make_message<buffer_message_t>(
+                this->local.data(), this->local.size(), done));
+    }
+
+    void complete_phase_(double endTime)
+    {
+        auto cb = cmk::callback<cmk::data_message<double>>::construct<
+            ::phase_completed_>(0);
+        cb.send(cmk::make_message<cmk::data_message<double>>(
+            endTime - this->startTime));
+    }
 };
 
 CthThread th;
@@ -110,17 +170,27 @@ int main(int argc, char** argv)
         std::size_t nIts = (argc >= 3) ? atoll(argv[2]) : 128;
         CmiPrintf(
             "main> pingpong with %luB payload and %lu iterations\n", sz, nIts);
-        // allocate the launch pack
-        auto msg = cmk::make_message<run_message_t>(sz, nIts);
-        // then run through a warm up phase
-        grp[0].send<run_message_t, &pingpong::run>(msg->clone<run_message_t>());
-        CthSuspend();
-        // then run through the measurement phase
-        grp[0].send<run_message_t, &pingpong::run>(std::move(msg));
-        CthSuspend();
-        // print the final round-trip time
-        CmiPrintf("main> roundtrip time was %g us\n",
-            (1e6 * lastTime) / (double) nIts);
+        // measure with the payload in the message, then referenced by it
+        for (auto zeroCopy : {false, true})
+        {
+            // allocate the launch pack
+            auto msg = cmk::make_message<run_message_t>(sz, nIts, zeroCopy);
+            // then run through a warm up phase
+            grp[0].send<run_message_t, &pingpong::run>(
+                msg->clone<run_message_t>());
+            CthSuspend();
+            // then run through the measurement phase
+            grp[0].send<run_message_t, &pingpong::run>(std::move(msg));
+            CthSuspend();
+            // print the final round-trip time
+            CmiPrintf("main> %s roundtrip time was %g us\n",
+                zeroCopy ? "zero-copy" : "message",
+                (1e6 * lastTime) / (double) nIts);
+        }
+        // and how often this pe's message pool was used
+        auto& stats = cmk::get_message_pool_stats();
+        CmiPrintf("main> message pool had %lu hit(s) and %lu miss(es)\n",
+            stats.hits, stats.misses);
         // then exit
         cmk::exit();
     }
@@ -0,0 +1,167 @@
+/* charmlite priorities benchmark
+ *
+ * each member of a group floods itself with (slow) low-priority work,
+ * while a token circulates through the group. the token's round trip is
+ * the critical path, which priorities let it skip the flood along
+ */
+
+#include <cmk.hh>
+
+// the number of work messages (per pe), and whether to use priorities
+using round_message_t = cmk::data_message<std::pair<int, bool>>;
+// the time the token was sent (on pe0)
+using token_message_t = cmk::data_message<double>;
+
+// how long each work message takes (in seconds)
+constexpr double workTime = 10e-6;
+// the (integer) priorities of the work, and the token
+constexpr int lowPriority = 1024;
+constexpr int highPriority = -1024;
+
+void round_completed_(cmk::message_ptr<>&& msg);
+
+double latency;
+
+// a chare that uses an int for its index
+struct member : public cmk::chare<member, int>
+{
+    int nWork;
+    int nDone;
+    bool prioritized;
+    bool tokenReturned;
+
+    member(void)
+      : nWork(0)
+      , nDone(0)
+      , prioritized(false)
+      , tokenReturned(false)
+    {
+    }
+
+    void run(cmk::message_ptr<round_message_t>&& msg)
+    {
+        this->nWork = msg->value().first;
+        this->prioritized = msg->value().second;
+        this->tokenReturned = (this->index() != 0);
+        auto self = this->element_proxy();
+        for (int i = 0; i < this->nWork; i++)
+        {
+            auto work = cmk::make_message<cmk::message>();
+            if (this->prioritized)
+            {
+                self.send<cmk::message, &member::work>(
+                    std::move(work), lowPriority);
+            }
+            else
+            {
+                self.send<cmk::message, &member::work>(std::move(work));
+            }
+        }
+        if (this->index() == 0)
+        {
+            this->forward_(
+                cmk::make_message<token_message_t>(CmiWallTimer()));
+        }
+    }
+
+    void work(cmk::message_ptr<>&&)
+    {
+        auto start = CmiWallTimer();
+        while ((CmiWallTimer() - start) < workTime)
+        {
+        }
+        this->nDone++;
+        this->try_finish_();
+    }
+
+    void token(cmk::message_ptr<token_message_t>&& msg)
+    {
+        if (this->index() == 0)
+        {
+            latency = CmiWallTimer() - msg->value();
+            this->tokenReturned = true;
+            this->try_finish_();
+        }
+        else
+        {
+            this->forward_(std::move(msg));
+        }
+    }
+
+private:
+    void forward_(cmk::message_ptr<token_message_t>&& msg)
+    {
+        auto col = cmk::group_proxy<member>(this->collection());
+        auto next = col[(this->index() + 1) % CmiNumPes()];
+        if (this->prioritized)
+        {
+            next.send<token_message_t, &member::token>(
+                std::move(msg), highPriority);
+        }
+        else
+        {
+            next.send<token_message_t, &member::token>(std::move(msg));
+        }
+    }
+
+    void try_finish_(void)
+    {
+        if (this->tokenReturned && (this->nDone == this->nWork))
+        {
+            this->nDone = 0;
+            this->tokenReturned = false;
+            auto cb =
+                cmk::callback<cmk::message>::construct<round_completed_>(0);
+            this->element_proxy().contribute<cmk::message, cmk::nop>(
+                cmk::make_message<cmk::message>(), cb);
+        }
+    }
+};
+
+CthThread th;
+
+void round_completed_(cmk::message_ptr<>&& msg)
+{
+    CthAwaken(th);
+}
+
+// returns the token's average round trip (in seconds)
+double measure(const cmk::group_proxy<member>& grp, int nWork,
+    bool prioritized, std::size_t nIts)
+{
+    double sum = 0;
+    // the first (few) rounds are a warm up
+    for (std::size_t it = 0; it < (nIts + 2); it++)
+    {
+        grp.broadcast<round_message_t, &member::run>(
+            cmk::make_message<round_message_t>(nWork, prioritized));
+        CthSuspend();
+        if (it >= 2)
+        {
+            sum += latency;
+        }
+    }
+    return sum / (double) nIts;
+}
+
+int main(int argc, char** argv)
+{
+    cmk::initialize(argc, argv);
+    if (CmiMyNode() == 0)
+    {
+        th = CthSelf();
+        CmiAssert(th && CthIsSuspendable(th));
+        std::size_t nIts = (argc >= 2) ? atoll(argv[1]) : 16;
+        int nWork = (argc >= 3) ? atoi(argv[2]) : 256;
+        auto grp = cmk::group_proxy<member>::construct();
+        CmiPrintf("main> %d work messages (of %g us) per pe\n", nWork,
+            1e6 * workTime);
+        CmiPrintf("main> token round trip: %g us in order, %g us by "
+                  "priority\n",
+            1e6 * measure(grp, nWork, false, nIts),
+            1e6 * measure(grp, nWork, true, nIts));
+        cmk::exit();
+    }
+    cmk::finalize();
+    return 0;
+}
@@ -0,0 +1,119 @@
+/* charmlite quiescence detection demo
+ *
+ * each element of an array starts a cascade of messages (each of which
+ * spawns two more until its depth runs out) without knowing when it ends,
+ * then main waits for quiescence and checks that every message arrived
+ */
+
+#include <cmk.hh>
+
+using depth_message_t = cmk::data_message<int>;
+using count_message_t = cmk::data_message<int>;
+
+constexpr int maxDepth = 6;
+
+void quiescent_(cmk::message_ptr<>&& msg);
+void counted_(cmk::message_ptr<count_message_t>&& msg);
+
+// a chare that uses an int for its index
+struct member : public cmk::chare<member, int>
+{
+    int nElts;
+    int nReceived;
+
+    member(void)
+      : nElts(0)
+      , nReceived(0)
+    {
+    }
+
+    void run(cmk::message_ptr<depth_message_t>&& msg)
+    {
+        // ( the number of elements is passed along with the first depth )
+        this->nElts = msg->value();
+        msg->value() = maxDepth;
+        this->spread(std::move(msg));
+    }
+
+    void spread(cmk::message_ptr<depth_message_t>&& msg)
+    {
+        this->nReceived++;
+        auto depth = msg->value();
+        if (depth == 0)
+        {
+            return;
+        }
+        auto col = cmk::collection_proxy<member>(this->collection());
+        for (int i = 1; i <= 2; i++)
+        {
+            auto next = (this->index() + i * depth) % this->nElts;
+            col[next].send<depth_message_t, &member::spread>(
+                cmk::make_message<depth_message_t>(depth - 1));
+        }
+    }
+
+    void count(cmk::message_ptr<>&&)
+    {
+        auto cb = cmk::callback<count_message_t>::construct<counted_>(0);
+        this->element_proxy().contribute<count_message_t, cmk::add<int>>(
+            cmk::make_message<count_message_t>(this->nReceived), cb);
+        this->nReceived = 0;
+    }
+};
+
+CthThread th;
+
+void quiescent_(cmk::message_ptr<>&& msg)
+{
+    CthAwaken(th);
+}
+
+int nCounted;
+
+void counted_(cmk::message_ptr<count_message_t>&& msg)
+{
+    nCounted = msg->value();
+    CthAwaken(th);
+}
+
+int main(int argc, char** argv)
+{
+    cmk::initialize(argc, argv);
+    if (CmiMyNode() == 0)
+    {
+        th = CthSelf();
+        CmiAssert(th && CthIsSuspendable(th));
+        int nElts = (argc >= 2) ? atoi(argv[1]) : (8 * CmiNumPes());
+        cmk::collection_options<int> opts(nElts);
+        auto arr = cmk::collection_proxy<member>::construct(opts);
+        auto cb = cmk::callback<cmk::message>::construct<quiescent_>(0);
+        // (each cascade is a complete binary tree of messages)
+        auto expected = nElts * ((1 << (maxDepth + 1)) - 1);
+        // wait for the array's messages, then for every message
+        for (auto all : {false, true})
+        {
+            auto startTime = CmiWallTimer();
+            arr.broadcast<depth_message_t, &member::run>(
+                cmk::make_message<depth_message_t>(nElts));
+            if (all)
+            {
+                cmk::on_quiescence(cb);
+            }
+            else
+            {
+                cmk::on_quiescence(arr, cb);
+            }
+            CthSuspend();
+            CmiPrintf("main> %s quiescent after %g ms\n",
+                all ? "system" : "array", 1e3 * (CmiWallTimer() - startTime));
+            arr.broadcast<cmk::message, &member::count>(
+                cmk::make_message<cmk::message>());
+            CthSuspend();
+            CmiEnforceMsg(nCounted == expected, "messages went missing");
+        }
+        CmiPrintf("main> quiescence detection complete!\n");
+        cmk::exit();
+    }
+    cmk::finalize();
+    return 0;
+}
@@ -0,0 +1,82 @@
+/* charmlite pe-level reduction benchmark
+ *
+ * measures the rate of (nop) reductions over all pes
+ * with 1, 8 or 64 of them in flight at once
+ */
+
+#include <cmk.hh>
+
+using start_message_t = cmk::data_message<std::size_t>;
+
+void reduced_(cmk::message_ptr<>&&);
+
+// each pe contributes to (another) reduction
+void contribute_(void)
+{
+    cmk::reduce<cmk::message, cmk::nop, reduced_>(
+        cmk::make_message<cmk::message>());
+}
+
+void next_(cmk::message_ptr<>&&)
+{
+    contribute_();
+}
+
+void start_(cmk::message_ptr<start_message_t>&& msg)
+{
+    for (std::size_t i = 0; i < msg->value(); i++)
+    {
+        contribute_();
+    }
+}
+
+// the following are only accessed on pe0
+CthThread th;
+std::size_t nIssued, nCompleted, nReductions;
+
+void reduced_(cmk::message_ptr<>&& msg)
+{
+    if (++nCompleted == nReductions)
+    {
+        CthAwaken(th);
+    }
+    else if (nIssued < nReductions)
+    {
+        // keep the window full by starting another reduction
+        nIssued++;
+        auto cb = cmk::callback<cmk::message>::construct<next_>(cmk::all);
+        cb.send(std::move(msg));
+    }
+}
+
+double measure(std::size_t window)
+{
+    nIssued = std::min(window, nReductions);
+    nCompleted = 0;
+    auto startTime = CmiWallTimer();
+    auto cb = cmk::callback<start_message_t>::construct<start_>(cmk::all);
+    cb.send(cmk::make_message<start_message_t>(nIssued));
+    CthSuspend();
+    return (double) nReductions / (CmiWallTimer() - startTime);
+}
+
+int main(int argc, char** argv)
+{
+    cmk::initialize(argc, argv);
+    if (CmiMyNode() == 0)
+    {
+        th = CthSelf();
+        CmiAssert(th && CthIsSuspendable(th));
+        nReductions = (argc >= 2) ? atoll(argv[1]) : 4096;
+        for (std::size_t window : {1, 8, 64})
+        {
+            // warm up then measure
+            measure(window);
+            CmiPrintf("main> %zu outstanding: %g reductions/s\n", window,
+                measure(window));
+        }
+        cmk::exit();
+    }
+    cmk::finalize();
+    return 0;
+}
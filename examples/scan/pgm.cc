@@ -0,0 +1,89 @@
+/* charmlite prefix scan demo
+ *
+ * each member of a group contributes its index (plus one),
+ * then checks the inclusive and exclusive prefix sums
+ */
+
+#include <cmk.hh>
+
+using value_message_t = cmk::data_message<int>;
+
+void scanned_(cmk::message_ptr<>&&);
+
+// a chare that uses an int for its index
+struct member : public cmk::chare<member, int>
+{
+    int nReceived;
+
+    member(void)
+      : nReceived(0)
+    {
+    }
+
+    void run(cmk::message_ptr<>&&)
+    {
+        auto elt = this->element_proxy();
+        auto val = this->index() + 1;
+        elt.inclusive_scan<value_message_t, cmk::add<int>, &member::inclusive>(
+            cmk::make_message<value_message_t>(val));
+        elt.exclusive_scan<value_message_t, cmk::add<int>, &member::exclusive>(
+            cmk::make_message<value_message_t>(val));
+    }
+
+    void inclusive(cmk::message_ptr<value_message_t>&& msg)
+    {
+        auto n = this->index() + 1;
+        CmiEnforceMsg(msg->value() == ((n * (n + 1)) / 2),
+            "unexpected inclusive prefix");
+        this->received_();
+    }
+
+    void exclusive(cmk::message_ptr<value_message_t>&& msg)
+    {
+        auto n = this->index();
+        // the first element has nothing preceding it
+        CmiEnforceMsg((n == 0) ? (msg == nullptr) :
+                                 (msg->value() == ((n * (n + 1)) / 2)),
+            "unexpected exclusive prefix");
+        this->received_();
+    }
+
+private:
+    void received_(void)
+    {
+        if (++(this->nReceived) == 2)
+        {
+            this->nReceived = 0;
+            CmiPrintf("ch%d@pe%d> received its prefixes\n", this->index(),
+                CmiMyPe());
+            auto cb = cmk::callback<cmk::message>::construct<scanned_>(0);
+            this->element_proxy().contribute<cmk::message, cmk::nop>(
+                cmk::make_message<cmk::message>(), cb);
+        }
+    }
+};
+
+CthThread th;
+
+void scanned_(cmk::message_ptr<>&&)
+{
+    CthAwaken(th);
+}
+
+int main(int argc, char** argv)
+{
+    cmk::initialize(argc, argv);
+    if (CmiMyNode() == 0)
+    {
+        th = CthSelf();
+        CmiAssert(th && CthIsSuspendable(th));
+        auto grp = cmk::group_proxy<member>::construct();
+        grp.broadcast<cmk::message, &member::run>(
+            cmk::make_message<cmk::message>());
+        CthSuspend();
+        CmiPrintf("main> scans complete!\n");
+        cmk::exit();
+    }
+    cmk::finalize();
+    return 0;
+}
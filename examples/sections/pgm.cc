@@ -0,0 +1,92 @@
+/* charmlite section demo
+ *
+ * multicasts to a strided section and to a list of an array's elements,
+ * whose members then reduce the sum of their indices over the section
+ */
+
+#include <cmk.hh>
+
+struct member;
+
+using value_message_t = cmk::data_message<int>;
+using section_message_t = cmk::data_message<cmk::section_proxy<member>>;
+
+void summed_(cmk::message_ptr<value_message_t>&& msg);
+
+// a chare that uses an int for its index
+struct member : public cmk::chare<member, int>
+{
+    member(void) = default;
+
+    // members receive the section they're a part of
+    void run(cmk::message_ptr<section_message_t>&& msg)
+    {
+        auto cb = cmk::callback<value_message_t>::construct<summed_>(0);
+        this->element_proxy().contribute<value_message_t, cmk::add<int>>(
+            msg->value(), cmk::make_message<value_message_t>(this->index()),
+            cb);
+    }
+};
+
+CthThread th;
+int nSummed;
+
+void summed_(cmk::message_ptr<value_message_t>&& msg)
+{
+    nSummed = msg->value();
+    CthAwaken(th);
+}
+
+void check(const cmk::section_proxy<member>& sec, int expected)
+{
+    sec.multicast<section_message_t, &member::run>(
+        cmk::make_message<section_message_t>(sec));
+    CthSuspend();
+    CmiEnforceMsg(nSummed == expected, "unexpected sum");
+}
+
+int main(int argc, char** argv)
+{
+    cmk::initialize(argc, argv);
+    if (CmiMyNode() == 0)
+    {
+        th = CthSelf();
+        CmiAssert(th && CthIsSuspendable(th));
+        int nElts = (argc >= 2) ? atoi(argv[1]) : (8 * CmiNumPes());
+        std::size_t nIts = (argc >= 3) ? atoll(argv[2]) : 16;
+        cmk::collection_options<int> opts(nElts);
+        auto arr = cmk::collection_proxy<member>::construct(opts);
+        // every third element (starting from the first)
+        auto strided = arr.section(0, nElts, 3);
+        auto expected = 0;
+        for (auto i = 0; i < nElts; i += 3)
+        {
+            expected += i;
+        }
+        // the last few elements (one per pe, under the default mapping)
+        std::vector<int> indices;
+        for (auto i = nElts - 1; i >= (nElts - CmiNumPes()); i--)
+        {
+            indices.emplace_back(i);
+        }
+        auto listed = arr.section(indices);
+        auto listedSum = 0;
+        for (auto& i : indices)
+        {
+            listedSum += i;
+        }
+        // ( the trees are cached after the first round )
+        auto startTime = CmiWallTimer();
+        for (std::size_t it = 0; it < nIts; it++)
+        {
+            check(strided, expected);
+            check(listed, listedSum);
+        }
+        CmiPrintf("main> %g us/multicast and reduction\n",
+            1e6 * (CmiWallTimer() - startTime) / (2 * nIts));
+        CmiPrintf("main> section demo complete!\n");
+        cmk::exit();
+    }
+    cmk::finalize();
+    return 0;
+}
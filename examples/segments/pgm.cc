@@ -0,0 +1,84 @@
+/* charmlite segmented reduction benchmark
+ *
+ * measures the bandwidth of group-wide sums of arrays
+ * across message sizes, with and without segmentation
+ */
+
+#include <cmk.hh>
+
+using vector_message_t = cmk::array_message<double>;
+// a tuple with (nElts, segment size) as its members
+using run_message_t = cmk::data_message<std::tuple<std::size_t, std::size_t>>;
+
+void reduced_(cmk::message_ptr<vector_message_t>&&);
+
+// a chare that uses an int for its index
+struct member : public cmk::chare<member, int>
+{
+    member(void) = default;
+
+    void run(cmk::message_ptr<run_message_t>&& msg)
+    {
+        auto& val = msg->value();
+        // every pe has to agree on the segment size
+        cmk::set_segment_size(std::get<1>(val));
+        auto cb = cmk::callback<vector_message_t>::construct<reduced_>(0);
+        this->element_proxy()
+            .contribute<vector_message_t, cmk::sum<vector_message_t>>(
+                vector_message_t::make(std::get<0>(val), 1.0), cb);
+    }
+};
+
+CthThread th;
+
+void reduced_(cmk::message_ptr<vector_message_t>&& msg)
+{
+    auto& last = (*msg)[msg->size() - 1];
+    CmiEnforceMsg(((*msg)[0] == CmiNumPes()) && (last == CmiNumPes()),
+        "unexpected reduction result");
+    CthAwaken(th);
+}
+
+// returns the bandwidth of a reduction (in GB/s)
+double measure(cmk::group_proxy<member>& grp, std::size_t nElts,
+    std::size_t segSize, std::size_t nIts)
+{
+    double startTime;
+    // the first round is a warm up
+    for (std::size_t it = 0; it < (nIts + 1); it++)
+    {
+        if (it == 1)
+        {
+            startTime = CmiWallTimer();
+        }
+        grp.broadcast<run_message_t, &member::run>(
+            cmk::make_message<run_message_t>(nElts, segSize));
+        CthSuspend();
+    }
+    auto elapsed = (CmiWallTimer() - startTime) / nIts;
+    return (nElts * sizeof(double)) / (elapsed * 1e9);
+}
+
+int main(int argc, char** argv)
+{
+    cmk::initialize(argc, argv);
+    if (CmiMyNode() == 0)
+    {
+        th = CthSelf();
+        CmiAssert(th && CthIsSuspendable(th));
+        std::size_t segSize = (argc >= 2) ? atoll(argv[1]) : (1 << 20);
+        std::size_t nIts = (argc >= 3) ? atoll(argv[2]) : 8;
+        auto grp = cmk::group_proxy<member>::construct();
+        // from 64KiB to 64MiB
+        for (std::size_t sz = (1 << 16); sz <= (1 << 26); sz *= 4)
+        {
+            auto nElts = sz / sizeof(double);
+            CmiPrintf("main> %zu bytes: %g GB/s whole, %g GB/s segmented\n",
+                sz, measure(grp, nElts, 0, nIts),
+                measure(grp, nElts, segSize, nIts));
+        }
+        cmk::exit();
+    }
+    cmk::finalize();
+    return 0;
+}
@@ -0,0 +1,158 @@
+/* charmlite serialization demo
+ *
+ * the first member of a group sends every member a value built from
+ * standard containers (and a user-defined type), which is serialized
+ * automatically whenever it leaves its node. the members then reduce
+ * their records' labels, whose contributions (with their continuations)
+ * are packed on their way to other nodes (so run it on more than one)
+ */
+
+#include <cmk.hh>
+
+// a user-defined type, which lists its fields through pup
+struct particle
+{
+    std::string name;
+    std::vector<double> position;
+
+    template <typename Serializer>
+    void pup(Serializer& s)
+    {
+        s | name;
+        s | position;
+    }
+};
+
+struct record
+{
+    std::vector<double> values;
+    std::string label;
+    std::map<int, std::string> names;
+    std::vector<particle> particles;
+    std::tuple<int, std::string> tag;
+
+    template <typename Serializer>
+    void pup(Serializer& s)
+    {
+        s | values | label | names | particles | tag;
+    }
+};
+
+using record_message_t = cmk::data_message<record>;
+
+static_assert(
+    cmk::is_serializable<record>::value, "expected records to be serializable");
+
+// the labels of the members' records (by index), which are reduced
+using labels_message_t = cmk::data_message<std::map<int, std::string>>;
+
+cmk::message_ptr<labels_message_t> merge_labels_(
+    cmk::message_ptr<labels_message_t>&& lhs,
+    cmk::message_ptr<labels_message_t>&& rhs)
+{
+    auto& labels = rhs->value();
+    lhs->value().insert(labels.begin(), labels.end());
+    return std::move(lhs);
+}
+
+void received_(cmk::message_ptr<labels_message_t>&& msg);
+
+record make_record_(int n)
+{
+    record rec;
+    for (int i = 0; i < n; i++)
+    {
+        rec.values.push_back(i * 0.5);
+        rec.names[i] = "name-" + std::to_string(i);
+        rec.particles.push_back(particle{"p" + std::to_string(i),
+            std::vector<double>(i, (double) i)});
+    }
+    rec.label = "record of " + std::to_string(n);
+    rec.tag = std::make_tuple(n, std::string("tag"));
+    return rec;
+}
+
+// a chare that uses an int for its index
+struct member : public cmk::chare<member, int>
+{
+    member(void) {}
+
+    void run(cmk::message_ptr<cmk::data_message<int>>&& msg)
+    {
+        auto n = msg->value();
+        auto col = cmk::group_proxy<member>(this->collection());
+        for (int i = 0; i < CmiNumPes(); i++)
+        {
+            col[i].send<record_message_t, &member::receive>(
+                cmk::make_message<record_message_t>(make_record_(n + i)));
+        }
+    }
+
+    void receive(cmk::message_ptr<record_message_t>&& msg)
+    {
+        auto& rec = msg->value();
+        auto expected = make_record_(rec.values.size());
+        CmiEnforceMsg(rec.values == expected.values, "unexpected values");
+        CmiEnforceMsg(rec.label == expected.label, "unexpected label");
+        CmiEnforceMsg(rec.names == expected.names, "unexpected names");
+        CmiEnforceMsg(rec.tag == expected.tag, "unexpected tag");
+        CmiEnforceMsg(rec.particles.size() == expected.particles.size(),
+            "unexpected number of particles");
+        for (std::size_t i = 0; i < rec.particles.size(); i++)
+        {
+            CmiEnforceMsg(
+                (rec.particles[i].name == expected.particles[i].name) &&
+                    (rec.particles[i].position ==
+                        expected.particles[i].position),
+                "unexpected particle");
+        }
+        auto labels = cmk::make_message<labels_message_t>();
+        labels->value()[this->index()] = rec.label;
+        auto cb = cmk::callback<labels_message_t>::construct<received_>(0);
+        this->element_proxy().contribute<labels_message_t, merge_labels_>(
+            std::move(labels), cb);
+    }
+};
+
+// the following are only accessed on pe0
+CthThread th;
+int n;
+
+void received_(cmk::message_ptr<labels_message_t>&& msg)
+{
+    auto& labels = msg->value();
+    CmiEnforceMsg(labels.size() == (std::size_t) CmiNumPes(),
+        "unexpected number of labels");
+    for (int i = 0; i < CmiNumPes(); i++)
+    {
+        CmiEnforceMsg(labels[i] == make_record_(n + i).label,
+            "unexpected label");
+    }
+    CthAwaken(th);
+}
+
+int main(int argc, char** argv)
+{
+    cmk::initialize(argc, argv);
+    if (CmiMyNode() == 0)
+    {
+        th = CthSelf();
+        CmiAssert(th && CthIsSuspendable(th));
+        n = (argc >= 2) ? atoi(argv[1]) : 16;
+        // report how large (serialized) records are
+        auto rec = make_record_(n);
+        cmk::sizer s;
+        s | rec;
+        CmiPrintf("main> a record of %d serializes to %zu bytes\n", n,
+            s.size());
+        auto grp = cmk::group_proxy<member>::construct();
+        grp[0].send<cmk::data_message<int>, &member::run>(
+            cmk::make_message<cmk::data_message<int>>(n));
+        CthSuspend();
+        CmiPrintf("main> every member received its record, and the "
+                  "labels were reduced!\n");
+        cmk::exit();
+    }
+    cmk::finalize();
+    return 0;
+}
@@ -0,0 +1,73 @@
+/* charmlite collective-tree benchmark
+ *
+ * measures the latency of a broadcast followed by
+ * a reduction over groups with different tree shapes
+ * ( use "make sweep" to vary the number of pes )
+ */
+
+#include <cmk.hh>
+
+void round_completed_(cmk::message_ptr<>&& msg);
+
+// a chare that uses an int for its index
+struct member : public cmk::chare<member, int>
+{
+    member(void) = default;
+
+    void ping(cmk::message_ptr<const cmk::message>&&)
+    {
+        auto cb = cmk::callback<cmk::message>::construct<round_completed_>(0);
+        this->element_proxy().contribute<cmk::message, cmk::nop>(
+            cmk::make_message<cmk::message>(), cb);
+    }
+};
+
+CthThread th;
+
+void round_completed_(cmk::message_ptr<>&& msg)
+{
+    CthAwaken(th);
+}
+
+double measure(const cmk::tree_shape& shape, std::size_t nIts)
+{
+    auto grp = cmk::group_proxy<member>::construct_with_tree(shape);
+    double startTime;
+    // the first (few) rounds are a warm up
+    for (std::size_t it = 0; it < (nIts + 2); it++)
+    {
+        if (it == 2)
+        {
+            startTime = CmiWallTimer();
+        }
+        grp.broadcast<const cmk::message, &member::ping>(
+            cmk::make_message<cmk::message>());
+        CthSuspend();
+    }
+    return (CmiWallTimer() - startTime) / (double) nIts;
+}
+
+int main(int argc, char** argv)
+{
+    cmk::initialize(argc, argv);
+    if (CmiMyNode() == 0)
+    {
+        th = CthSelf();
+        CmiAssert(th && CthIsSuspendable(th));
+        std::size_t nIts = (argc >= 2) ? atoll(argv[1]) : 1024;
+        const std::pair<const char*, cmk::tree_shape> shapes[] = {
+            {"2-ary", cmk::tree_shape::kary(2)},
+            {"4-ary", cmk::tree_shape::kary(4)},
+            {"8-ary", cmk::tree_shape::kary(8)},
+            {"binomial", cmk::tree_shape::binomial()},
+            {"node-aware", cmk::tree_shape::node_aware()}};
+        for (auto& shape : shapes)
+        {
+            CmiPrintf("main> %d pes, %s tree: %g us per broadcast+reduction\n",
+                CmiNumPes(), shape.first, 1e6 * measure(shape.second, nIts));
+        }
+        cmk::exit();
+    }
+    cmk::finalize();
+    return 0;
+}
@@ -0,0 +1,253 @@
+#ifndef __CMK_AGGREGATOR_HH__
+#define __CMK_AGGREGATOR_HH__
+
+#include "message.hh"
+
+namespace cmk {
+    // define as zero to disable aggregation by default
+#ifndef CHARMLITE_AGGREGATE_SIZE
+#define CHARMLITE_AGGREGATE_SIZE (1 << 14)
+#endif
+
+    // stands in for an aggregated message's common fields, which are
+    // rebuilt (from these) when it's unpacked
+    struct aggregate_item_
+    {
+        collection_index_t collection;
+        chare_index_t chare;
+        entry_id_t entry;
+        message_kind_t kind;
+        // the size of the message past its common fields
+        std::uint32_t size;
+        std::uint8_t flags;
+    };
+
+    inline std::size_t aggregate_align_(std::size_t sz)
+    {
+        return ((sz + ALIGN_BYTES - 1) / ALIGN_BYTES) * ALIGN_BYTES;
+    }
+
+    // the room an item (with a body of the given size) takes up
+    inline std::size_t aggregate_item_size_(std::size_t size)
+    {
+        return aggregate_align_(sizeof(aggregate_item_)) +
+            aggregate_align_(size);
+    }
+
+    void aggregate_handler_(void*);
+    void aggregate_flush_handler_(void*);
+
+    // a buffer of messages bound for a pe, which bypasses our converse
+    // handler (since its messages are counted individually)
+    struct aggregate_message_
+    {
+        std::array<char, CmiMsgHeaderSizeBytes> core_;
+        std::size_t n_items;
+        // the bytes in use (including these fields)
+        std::size_t total_size;
+
+        static constexpr std::size_t items_offset_(void)
+        {
+            return ((sizeof(aggregate_message_) + ALIGN_BYTES - 1) /
+                       ALIGN_BYTES) *
+                ALIGN_BYTES;
+        }
+
+        // copies a (packed) endpoint message into the buffer
+        void append(message* msg)
+        {
+            auto size = msg->total_size_ - sizeof(message);
+            auto* base = reinterpret_cast<char*>(this) + this->total_size;
+            auto* item = reinterpret_cast<aggregate_item_*>(base);
+            auto& ep = msg->dst_.endpoint();
+            *item = aggregate_item_{ep.collection, ep.chare, ep.entry,
+                msg->kind_, (std::uint32_t) size,
+                (std::uint8_t) msg->flags_.to_ulong()};
+            std::memcpy(base + aggregate_align_(sizeof(aggregate_item_)),
+                reinterpret_cast<char*>(msg) + sizeof(message), size);
+            this->total_size += aggregate_item_size_(size);
+            this->n_items++;
+        }
+
+        // rebuilds each message in the buffer, passing them to fn in order
+        template <typename Fn>
+        void for_each(const Fn& fn)
+        {
+            auto* base = reinterpret_cast<char*>(this) + items_offset_();
+            for (std::size_t i = 0; i < this->n_items; i++)
+            {
+                auto* item = reinterpret_cast<aggregate_item_*>(base);
+                auto sz = sizeof(message) + item->size;
+                auto* msg = ::new (allocate_message_(sz))
+                    message(item->kind, sz);
+                msg->flags_ = flag_set_(item->flags);
+                new (&(msg->dst_))
+                    destination(item->collection, item->chare, item->entry);
+                std::memcpy(reinterpret_cast<char*>(msg) + sizeof(message),
+                    base + aggregate_align_(sizeof(aggregate_item_)),
+                    item->size);
+                base += aggregate_item_size_(item->size);
+                fn(message_ptr<>(msg));
+            }
+        }
+    };
+
+    // buffers small messages bound for each pe, sending them together
+    // once a buffer fills (or is flushed). buffers are flushed by a token
+    // queued behind the work that filled them, so messages wait (at most)
+    // until the scheduler gets through its queue
+    class aggregator_
+    {
+        int handler_;
+        int flush_handler_;
+        std::size_t capacity_;
+        // the buffers bound for each pe (by pe, null when empty)
+        std::vector<aggregate_message_*> buffers_;
+        // and the pes whose buffers are in use
+        std::vector<int> active_;
+        bool flush_queued_;
+
+    public:
+        aggregator_(void)
+          : handler_(-1)
+          , flush_handler_(-1)
+          , capacity_(CHARMLITE_AGGREGATE_SIZE)
+          , flush_queued_(false)
+        {
+        }
+
+        aggregator_(const aggregator_&) = delete;
+
+        void initialize(void)
+        {
+            this->handler_ = CmiRegisterHandler(aggregate_handler_);
+            this->flush_handler_ = CmiRegisterHandler(aggregate_flush_handler_);
+        }
+
+        void set_capacity(std::size_t sz)
+        {
+            this->flush();
+            this->capacity_ = sz;
+        }
+
+        // buffers an endpoint message bound for pe (sending it directly
+        // when it cannot be aggregated)
+        void send(int pe, message_ptr<>&& msg)
+        {
+            if ((pe == CmiMyPe()) || !this->accepts_(msg))
+            {
+                cmk::send(std::move(msg));
+                return;
+            }
+            pack_message(msg);
+            auto nbytes =
+                aggregate_item_size_(msg->total_size_ - sizeof(message));
+            if ((aggregate_message_::items_offset_() + nbytes) >
+                this->capacity_)
+            {
+                // too large to be worth buffering
+                send_helper_(pe, std::move(msg));
+                return;
+            }
+            if (this->buffers_.empty())
+            {
+                this->buffers_.resize(CmiNumPes(), nullptr);
+            }
+            auto*& buf = this->buffers_[pe];
+            if (buf == nullptr)
+            {
+                buf = this->make_();
+                this->active_.push_back(pe);
+            }
+            else if ((buf->total_size + nbytes) > this->capacity_)
+            {
+                this->send_(pe, buf);
+                buf = this->make_();
+            }
+            // (counted now, so quiescence waits for the buffer)
+            count_created_(msg->dst_, 1);
+            buf->append(msg.get());
+            message::free(msg);
+            if (!this->flush_queued_)
+            {
+                this->queue_flush_();
+            }
+        }
+
+        // sends every (non-empty) buffer
+        void flush(void)
+        {
+            for (auto& pe : this->active_)
+            {
+                auto*& buf = this->buffers_[pe];
+                this->send_(pe, buf);
+                buf = nullptr;
+            }
+            this->active_.clear();
+        }
+
+        void handle_flush(void* token)
+        {
+            this->flush_queued_ = false;
+            this->flush();
+            CmiFree(token);
+        }
+
+    private:
+        bool accepts_(message_ptr<>& msg)
+        {
+            // only plain, point-to-point sends to existing elements
+            return (this->capacity_ > 0) &&
+                (msg->dst_.kind() == kEndpoint) && !msg->is_broadcast() &&
+                !msg->has_collection_kind() && !msg->has_combiner() &&
+                !msg->has_continuation() && !msg->has_priority();
+        }
+
+        aggregate_message_* make_(void)
+        {
+            auto* buf = static_cast<aggregate_message_*>(
+                CmiAlloc(this->capacity_));
+            CmiSetHandler(buf, this->handler_);
+            buf->n_items = 0;
+            buf->total_size = aggregate_message_::items_offset_();
+            return buf;
+        }
+
+        void send_(int pe, aggregate_message_* buf)
+        {
+            if (CmiNodeOf(pe) == CmiMyNode())
+            {
+                CmiPushPE(pe, buf);
+            }
+            else
+            {
+                CmiSyncSendAndFree(pe, buf->total_size, (char*) buf);
+            }
+        }
+
+        void queue_flush_(void)
+        {
+            auto* token = CmiAlloc(CmiMsgHeaderSizeBytes);
+            CmiSetHandler(token, this->flush_handler_);
+            CsdEnqueue(token);
+            this->flush_queued_ = true;
+        }
+    };
+
+    CpvExtern(aggregator_, aggregator_);
+
+    // sends every buffered message (e.g., before waiting on a reply)
+    inline void flush_aggregates(void)
+    {
+        CpvAccess(aggregator_).flush();
+    }
+
+    // sets the size (in bytes) of aggregation buffers, where zero
+    // disables aggregation. this flushes this pe's buffers.
+    inline void set_aggregate_size(std::size_t sz)
+    {
+        CpvAccess(aggregator_).set_capacity(sz);
+    }
+}    // namespace cmk
+
+#endif
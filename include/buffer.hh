@@ -0,0 +1,178 @@
+#ifndef __CMK_BUFFER_HH__
+#define __CMK_BUFFER_HH__
+
+#include "callback.hh"
+
+namespace cmk {
+    void buffer_release_handler_(void*);
+    void buffer_ncpy_handler_(void*);
+
+    CpvExtern(int, buffer_release_handler_);
+
+    // tells a buffer's pe that a receiver is done with it
+    struct buffer_release_message_
+    {
+        std::array<char, CmiMsgHeaderSizeBytes> core_;
+        CmiNcpyBuffer src;
+        destination ack;
+    };
+
+    // a get in flight (referenced by converse's nocopy ack)
+    struct buffer_transfer_
+    {
+        CmiNcpyBuffer src;
+        CmiNcpyBuffer dst;
+        destination ack;
+        destination cont;
+    };
+
+    // sends an empty message to dst (when it's valid)
+    inline void buffer_notify_(const destination& dst)
+    {
+        if (dst.kind() != kInvalid)
+        {
+            auto msg = cmk::make_message<message>();
+            new (&(msg->dst_)) destination(dst);
+            cmk::send(std::move(msg));
+        }
+    }
+
+    // asks src's pe to release it, then invoke ack
+    inline void buffer_release_(
+        const CmiNcpyBuffer& src, const destination& ack)
+    {
+        auto sz = sizeof(buffer_release_message_);
+        auto* msg = static_cast<buffer_release_message_*>(CmiAlloc(sz));
+        CmiSetHandler(msg, CpvAccess(buffer_release_handler_));
+        new (&(msg->src)) CmiNcpyBuffer(src);
+        new (&(msg->ack)) destination(ack);
+        // (releases count towards quiescence, system-wide)
+        destination none;
+        count_created_(none, 1);
+        CmiSyncSendAndFree(src.pe, sz, reinterpret_cast<char*>(msg));
+    }
+
+    // (on the buffer's pe) deregisters its memory, then invokes its ack
+    inline void buffer_released_(buffer_release_message_* msg)
+    {
+        msg->src.deregisterMem();
+        buffer_notify_(msg->ack);
+    }
+
+    // (on the receiver) finishes a get
+    inline void buffer_complete_(buffer_transfer_* xfer)
+    {
+        xfer->dst.deregisterMem();
+        buffer_release_(xfer->src, xfer->ack);
+        buffer_notify_(xfer->cont);
+        delete xfer;
+    }
+
+    // copies src (from its pe) into dst (on this pe), then releases src
+    // and invokes cont (on this pe). pes sharing an address space copy
+    // it directly, others get it through converse's nocopy api (i.e.,
+    // by cma or rdma) without either side copying it into a message
+    inline void buffer_get_(const CmiNcpyBuffer& src, const destination& ack,
+        void* dst, const destination& cont)
+    {
+        if (CmiNodeOf(src.pe) == CmiMyNode())
+        {
+            std::memcpy(dst, src.ptr, src.cnt);
+            buffer_release_(src, ack);
+            buffer_notify_(cont);
+            return;
+        }
+        auto* xfer =
+            new buffer_transfer_{src, CmiNcpyBuffer(dst, src.cnt), ack, cont};
+        switch (findTransferMode(src.pe, CmiMyPe()))
+        {
+        case ncpyTransferMode::MEMCPY:
+            xfer->dst.memcpyGet(xfer->src);
+            buffer_complete_(xfer);
+            break;
+#if CMK_USE_CMA
+        case ncpyTransferMode::CMA:
+            xfer->dst.cmaGet(xfer->src);
+            buffer_complete_(xfer);
+            break;
+#endif
+        default:
+        {
+            // completes in buffer_ncpy_handler_ (which counts it)
+            destination none;
+            count_created_(none, 1);
+            auto* ref = reinterpret_cast<char*>(&xfer);
+            xfer->dst.rdmaGet(xfer->src, sizeof(xfer), ref, ref);
+            break;
+        }
+        }
+    }
+
+    // (on the receiver) finishes an rdma get
+    inline void buffer_ncpy_ack_(NcpyOperationInfo* info)
+    {
+        auto* xfer = *reinterpret_cast<buffer_transfer_**>(info->destAck);
+        if (info->freeMe == CMK_FREE_NCPYOPINFO)
+        {
+            CmiFree(info);
+        }
+        destination none;
+        count_processed_(none);
+        buffer_complete_(xfer);
+    }
+
+    // a reference to a pe's (contiguous) memory, which can be sent in
+    // place of the memory itself. receivers then get it directly into
+    // their own memory, and the pe is notified once it can be reused.
+    // the memory must be left as-is (and alive) until then, and each
+    // buffer should be fetched once (since that releases it)
+    template <typename T>
+    class buffer
+    {
+        static_assert(std::is_trivially_copyable<T>::value,
+            "buffers are copied without packing");
+
+        // ( registered with the network layer until it's released )
+        CmiNcpyBuffer src_;
+        destination ack_;
+
+    public:
+        using type = T;
+
+        buffer(void) = default;
+
+        buffer(const T* ptr, std::size_t size)
+          : src_(ptr, size * sizeof(T))
+        {
+        }
+
+        // done is invoked (on this pe) once the receiver has the contents
+        buffer(const T* ptr, std::size_t size, const callback<message>& done)
+          : buffer(ptr, size)
+        {
+            done.imprint(this->ack_);
+        }
+
+        std::size_t size(void) const
+        {
+            return this->src_.cnt / sizeof(T);
+        }
+
+        // the pe that owns the memory
+        int pe(void) const
+        {
+            return this->src_.pe;
+        }
+
+        // copies the contents into dst (with room for size() elements),
+        // then invokes cont on this pe
+        void get(T* dst, const callback<message>& cont) const
+        {
+            destination dst_cont;
+            cont.imprint(dst_cont);
+            buffer_get_(this->src_, this->ack_, dst, dst_cont);
+        }
+    };
+}    // namespace cmk
+
+#endif
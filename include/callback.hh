@@ -44,6 +44,7 @@ namespace cmk {
     class callback
     {
         destination dst_;
+        priority prio_;
 
         template <typename... Args>
         callback(Args&&... args)
@@ -63,9 +64,28 @@ namespace cmk {
             new (&dst) destination(this->dst_);
         }
 
-        inline void imprint(const message_ptr<Message>& msg) const
+        // (continuations carry the priority to their results)
+        inline void imprint(continuation_& cont) const
+        {
+            this->imprint(cont.dst);
+            cont.prio = this->prio_;
+        }
+
+        inline void imprint(message_ptr<Message>& msg) const
         {
             this->imprint(msg->dst_);
+            if (this->prio_)
+            {
+                set_priority(msg, this->prio_);
+            }
+        }
+
+        // returns a copy of this callback that sends with a priority
+        callback<Message> with_priority(const priority& prio) const
+        {
+            auto cb = *this;
+            cb.prio_ = prio;
+            return cb;
         }
 
         void send(message_ptr<Message>&& msg)
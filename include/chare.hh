@@ -1,6 +1,9 @@
 #ifndef __CMK_CHARE_HH__
 #define __CMK_CHARE_HH__
 
+#include <algorithm>
+#include <cstddef>
+
 #include "options.hh"
 
 namespace cmk {
@@ -11,25 +14,134 @@ namespace cmk {
         static chare_kind_t kind_;
     };
 
+    // a per-pe arena for chares of a single kind. elements are bump
+    // allocated from geometrically growing blocks (so they are largely
+    // contiguous) with freed slots recycled through an intrusive list.
+    class chare_slab_
+    {
+        static constexpr std::size_t min_block_ = 64;
+        static constexpr std::size_t max_block_ = 65536;
+
+        struct node_
+        {
+            node_* next;
+        };
+
+        std::size_t stride_;
+        std::size_t next_block_;
+        std::vector<void*> blocks_;
+        char* cursor_;
+        char* limit_;
+        node_* free_;
+
+    public:
+        chare_slab_(std::size_t size)
+          : stride_(stride_for_(size))
+          , next_block_(min_block_)
+          , cursor_(nullptr)
+          , limit_(nullptr)
+          , free_(nullptr)
+        {
+        }
+
+        chare_slab_(chare_slab_&& other)
+          : stride_(other.stride_)
+          , next_block_(other.next_block_)
+          , blocks_(std::move(other.blocks_))
+          , cursor_(other.cursor_)
+          , limit_(other.limit_)
+          , free_(other.free_)
+        {
+            other.blocks_.clear();
+        }
+
+        chare_slab_(const chare_slab_&) = delete;
+
+        ~chare_slab_()
+        {
+            for (auto* blk : this->blocks_)
+            {
+                ::operator delete(blk);
+            }
+        }
+
+        void* allocate(void)
+        {
+            if (this->free_)
+            {
+                auto* slot = this->free_;
+                this->free_ = slot->next;
+                return slot;
+            }
+            else if (this->cursor_ == this->limit_)
+            {
+                // grow geometrically so 1M elements are ~20 allocations
+                auto n = this->next_block_;
+                auto* blk = static_cast<char*>(::operator new(n * stride_));
+                this->blocks_.emplace_back(blk);
+                this->cursor_ = blk;
+                this->limit_ = blk + (n * stride_);
+                this->next_block_ = std::min(2 * n, max_block_);
+            }
+            auto* slot = this->cursor_;
+            this->cursor_ += this->stride_;
+            return slot;
+        }
+
+        void deallocate(void* obj)
+        {
+            auto* slot = static_cast<node_*>(obj);
+            slot->next = this->free_;
+            this->free_ = slot;
+        }
+
+    private:
+        static std::size_t stride_for_(std::size_t size)
+        {
+            // keep every slot max-aligned (and large enough to link)
+            constexpr auto align = alignof(std::max_align_t);
+            size = std::max(size, sizeof(node_));
+            return ((size + align - 1) / align) * align;
+        }
+    };
+
+    using chare_slab_table_t = std::vector<chare_slab_>;
+    CpvExtern(chare_slab_table_t, chare_slabs_);
+
     struct chare_record_
     {
         const char* name_;
         std::size_t size_;
+        chare_kind_t kind_;
 
-        chare_record_(const char* name, std::size_t size)
+        chare_record_(const char* name, std::size_t size, chare_kind_t kind)
           : name_(name)
           , size_(size)
+          , kind_(kind)
         {
         }
 
         void* allocate(void) const
         {
-            return ::operator new(this->size_);
+            return this->slab_().allocate();
         }
 
         void deallocate(void* obj) const
         {
-            ::operator delete(obj);
+            this->slab_().deallocate(obj);
+        }
+
+    private:
+        // get (or lazily create) this pe's slab for our kind
+        chare_slab_& slab_(void) const
+        {
+            auto& slabs = CpvAccess(chare_slabs_);
+            while (slabs.size() < this->kind_)
+            {
+                auto& rec = CsvAccess(chare_table_)[slabs.size()];
+                slabs.emplace_back(rec.size_);
+            }
+            return slabs[this->kind_ - 1];
         }
     };
 
@@ -40,6 +152,20 @@ namespace cmk {
         return CsvAccess(chare_table_)[id - 1];
     }
 
+    // destroys a chare and returns its storage to its slab
+    template <typename T>
+    struct chare_deleter_
+    {
+        void operator()(T* obj) const
+        {
+            obj->~T();
+            record_for<T>().deallocate(obj);
+        }
+    };
+
+    template <typename T>
+    using chare_ptr_ = std::unique_ptr<T, chare_deleter_<T>>;
+
     template <typename T, typename Enable = void>
     struct property_setter_
     {
@@ -54,24 +180,66 @@ namespace cmk {
 
     struct reducer_
     {
-        std::vector<chare_index_t> upstream;
-        std::vector<chare_index_t> downstream;
-        std::vector<message_ptr<message>> received;
+        // the partial result (combined as messages arrive)
+        message_ptr<message> partial;
+        std::size_t received;
+        // a message from all our children and from us
+        std::size_t expected;
 
-        reducer_(
-            std::vector<chare_index_t>&& up, std::vector<chare_index_t>&& down)
-          : upstream(std::move(up))
-          , downstream(std::move(down))
+        reducer_(std::size_t n_children)
+          : received(0)
+          , expected(n_children + 1)
         {
         }
 
         bool ready(void) const
         {
-            // a message from all our children and from us
-            return received.size() == (upstream.size() + 1);
+            return received == expected;
         }
     };
 
+    // combines the partials of a collection's pes within a node, with
+    // the pes that contribute them taking turns under its lock
+    struct node_reducer_
+    {
+        CmiNodeLock lock;
+        flat_map<bcast_id_t, reducer_> reducers;
+
+        node_reducer_(void)
+          : lock(CmiCreateLock())
+        {
+        }
+
+        node_reducer_(const node_reducer_&) = delete;
+
+        ~node_reducer_()
+        {
+            CmiDestroyLock(this->lock);
+        }
+    };
+
+    using node_reducer_table_t =
+        collection_flat_map_<std::unique_ptr<node_reducer_>>;
+
+    CsvExtern(node_reducer_table_t, node_reducers_);
+    CsvExtern(CmiNodeLock, node_reducers_lock_);
+
+    // finds (or creates) the node's accumulator for a collection
+    inline node_reducer_* node_reducer_for_(const collection_index_t& id)
+    {
+        auto& lock = CsvAccess(node_reducers_lock_);
+        auto& table = CsvAccess(node_reducers_);
+        CmiLock(lock);
+        auto& ptr = table[id];
+        if (!ptr)
+        {
+            ptr.reset(new node_reducer_);
+        }
+        auto* red = ptr.get();
+        CmiUnlock(lock);
+        return red;
+    }
+
     struct chare_base_
     {
     private:
@@ -80,7 +248,7 @@ namespace cmk {
         bcast_id_t last_redn_ = 0;
         bcast_id_t last_bcast_ = 0;
 
-        using reducer_map_t = std::unordered_map<bcast_id_t, reducer_>;
+        using reducer_map_t = flat_map<bcast_id_t, reducer_>;
         reducer_map_t reducers_;
 
     public:
@@ -1,9 +1,12 @@
 #ifndef __CMK_HH__
 #define __CMK_HH__
 
+#include "buffer.hh"
 #include "collection.hh"
+#include "combiners.hh"
 #include "core.hh"
 #include "proxy.hh"
+#include "quiescence.hh"
 #include "reduction.hh"
 
 // ( no reordering )
@@ -8,10 +8,20 @@
  */
 
 namespace cmk {
+    // the id of a table's next entry (which has to fit into Id)
+    template <typename Id, typename Table>
+    static Id next_id_(const Table& table)
+    {
+        auto id = table.size() + 1;
+        CmiEnforceMsg(id <= (std::size_t) std::numeric_limits<Id>::max(),
+            "too many registrations for the message header's ids");
+        return (Id) id;
+    }
+
     template <entry_fn_t Fn, bool Constructor>
     static entry_id_t register_entry_fn_(void)
     {
-        auto id = CsvAccess(entry_table_).size() + 1;
+        auto id = next_id_<entry_id_t>(CsvAccess(entry_table_));
         CsvAccess(entry_table_).emplace_back(Fn, Constructor);
         return id;
     }
@@ -24,7 +34,7 @@ namespace cmk {
     static chare_kind_t register_chare_(void)
     {
         auto id = CsvAccess(chare_table_).size() + 1;
-        CsvAccess(chare_table_).emplace_back(typeid(T).name(), sizeof(T));
+        CsvAccess(chare_table_).emplace_back(typeid(T).name(), sizeof(T), id);
         return id;
     }
 
@@ -47,7 +57,7 @@ namespace cmk {
     template <typename T, template <class> class Mapper>
     static collection_kind_t register_collection_(void)
     {
-        auto id = CsvAccess(collection_kinds_).size() + 1;
+        auto id = next_id_<collection_kind_t>(CsvAccess(collection_kinds_));
         CsvAccess(collection_kinds_)
             .emplace_back(&construct_collection_<T, Mapper>);
         return id;
@@ -67,10 +77,12 @@ namespace cmk {
     static message_kind_t register_message_(void)
     {
         using properties_type = message_properties_extractor_<T>;
-        auto id = CsvAccess(message_table_).size() + 1;
+        auto id = next_id_<message_kind_t>(CsvAccess(message_table_));
         CsvAccess(message_table_)
             .emplace_back(&message_deleter_impl_<T>, properties_type::packer(),
-                properties_type::unpacker());
+                properties_type::unpacker(),
+                std::is_trivially_destructible<T>::value,
+                is_array_message_<T>::value);
         return id;
     }
 
@@ -134,12 +146,13 @@ namespace cmk {
 
     template <typename Message, template <class> class Function,
         Function<Message> Fn>
-    static std::size_t register_function_(std::vector<Function<message>>& table)
+    static table_id_t_<std::vector<Function<message>>> register_function_(
+        std::vector<Function<message>>& table)
     {
         // get a type-erased version of the function
         constexpr auto fn = function_wrapper_<Message, Function, Fn>::fn();
         // then register it
-        auto id = table.size() + 1;
+        auto id = next_id_<table_id_t_<std::vector<Function<message>>>>(table);
         table.emplace_back(fn);
         return id;
     }
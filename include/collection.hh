@@ -4,8 +4,11 @@
 #include "callback.hh"
 #include "chare.hh"
 #include "ep.hh"
+#include "gather.hh"
 #include "locmgr.hh"
 #include "message.hh"
+#include "section.hh"
+#include "storage.hh"
 
 namespace cmk {
     class collection_base_
@@ -20,8 +23,19 @@ namespace cmk {
         }
         virtual ~collection_base_() = default;
         virtual void* lookup(const chare_index_t&) = 0;
+        // the pe that messages bound for an element are sent to
+        virtual int home_pe(const chare_index_t&) = 0;
         virtual void deliver(message_ptr<>&& msg, bool immediate) = 0;
         virtual void contribute(message_ptr<>&& msg) = 0;
+        virtual void contribute(
+            const section_index_t& sid, message_ptr<>&& msg) = 0;
+        virtual void scan(
+            message_ptr<>&& msg, combiner_id_t comb, bool inclusive) = 0;
+        virtual void barrier(
+            const chare_index_t& idx, const continuation_& cont) = 0;
+        virtual void gather(message_ptr<>&& msg, message_kind_t kind,
+            const continuation_& cont) = 0;
+        virtual void all_to_all(message_ptr<>&& msg) = 0;
 
         template <typename T>
         inline T* lookup(const chare_index_t& idx)
@@ -30,6 +44,62 @@ namespace cmk {
         }
     };
 
+    // a pe's part of a scan over a collection
+    struct scanner_
+    {
+        combiner_id_t combiner = 0;
+        entry_id_t entry = nil_entry_;
+        bool inclusive = false;
+        // local elements' contributions (then their local prefixes)
+        std::vector<std::pair<chare_index_t, message_ptr<>>> locals;
+        // the totals of our children's subtrees (by position)
+        std::vector<message_ptr<>> uppers;
+        std::size_t n_uppers = 0;
+        // the total of our local elements
+        message_ptr<> total;
+        // the prefix preceding our subtree (null for the first pe)
+        message_ptr<> prefix;
+        bool swept_up = false;
+        bool has_prefix = false;
+    };
+
+    // a pe's part of a gather over a collection
+    struct gatherer_
+    {
+        // the kind (and continuation) of the gather's result
+        message_kind_t kind = 0;
+        continuation_ cont;
+        // local elements' contributions
+        std::vector<std::pair<chare_index_t, message_ptr<>>> locals;
+        // the merged contributions of our children's subtrees
+        std::vector<message_ptr<>> parts;
+    };
+
+    // a pe's part of a section's tree
+    struct section_
+    {
+        bool described = false;
+        int parent = -1;
+        std::vector<int> children;
+        // the section's members on this pe
+        std::vector<chare_index_t> locals;
+        // the number of reductions each of them started
+        chare_flat_map_<bcast_id_t> last_redn;
+        flat_map<bcast_id_t, reducer_> reducers;
+        // messages that arrived before the section's description
+        std::vector<message_ptr<>> pending;
+    };
+
+    // a pe's part of an all-to-all over a collection
+    struct exchanger_
+    {
+        // whether our elements' values were sent
+        bool sent = false;
+        std::vector<std::pair<chare_index_t, message_ptr<>>> locals;
+        // the values sent to our elements (one part from each pe)
+        std::vector<message_ptr<>> parts;
+    };
+
     template <typename T, template <class> class Mapper>
     class collection : public collection_base_
     {
@@ -39,8 +109,17 @@ namespace cmk {
     private:
         locmgr<Mapper<index_type>> locmgr_;
 
-        std::unordered_map<chare_index_t, message_buffer_t> buffers_;
-        std::unordered_map<chare_index_t, std::unique_ptr<T>> chares_;
+        chare_flat_map_<message_buffer_t> buffers_;
+        element_table_<T, index_type> chares_;
+        // this node's accumulator for our reductions (fetched on first use)
+        node_reducer_* accumulator_ = nullptr;
+        // scans in progress (by sequence number)
+        flat_map<bcast_id_t, scanner_> scans_;
+        // as above, for gathers and all-to-alls
+        flat_map<bcast_id_t, gatherer_> gathers_;
+        flat_map<bcast_id_t, exchanger_> exchanges_;
+        // the sections this pe is a part of
+        collection_flat_map_<section_> sections_;
 
     public:
         static_assert(
@@ -49,7 +128,9 @@ namespace cmk {
         collection(const collection_index_t& id,
             const collection_options<index_type>& opts, const message* msg)
           : collection_base_(id)
+          , chares_(opts)
         {
+            this->locmgr_.set_tree(opts.tree());
             // need valid message and options or neither
             CmiEnforceMsg(
                 ((bool) opts == (bool) msg), "cannot seed collection");
@@ -57,35 +138,50 @@ namespace cmk {
             {
                 auto& end = opts.end();
                 auto& step = opts.step();
-                // deliver a copy of the message to all "seeds"
+                std::vector<chare_index_t> seeds;
+                // determine which pes host "seeds" (and which are ours)
                 for (auto seed = opts.start(); seed != end; seed += step)
                 {
                     auto view = index_view<index_type>::encode(seed);
                     // NOTE ( I'm pretty sure this is no worse than what Charm )
                     //      ( does vis-a-vis CKARRAYMAP_POPULATE_INITIAL       )
                     // TODO ( that said, it should be elim'd for node/groups   )
-                    if (this->locmgr_.pe_for(view) == CmiMyPe())
+                    auto pe = this->locmgr_.pe_for(view);
+                    this->locmgr_.add_member(pe);
+                    if (pe == CmiMyPe())
                     {
-                        // message should be packed
-                        auto clone = msg->clone();
-                        clone->dst_.endpoint().chare = view;
-                        this->deliver_now(std::move(clone));
+                        seeds.emplace_back(view);
                     }
                 }
+                // our seeds are known, so size their storage
+                this->chares_.lay_out(seeds);
+                // then deliver a copy of the message to each of our seeds
+                // ( after membership is known so collectives can proceed )
+                for (auto& view : seeds)
+                {
+                    // message should be packed
+                    auto clone = msg->clone();
+                    clone->dst_.endpoint().chare = view;
+                    this->deliver_now(std::move(clone));
+                }
             }
         }
 
         virtual void* lookup(const chare_index_t& idx) override
         {
-            auto find = this->chares_.find(idx);
-            if (find == std::end(this->chares_))
-            {
-                return nullptr;
-            }
-            else
-            {
-                return (find->second).get();
-            }
+            return this->chares_.find(idx);
+        }
+
+        virtual int home_pe(const chare_index_t& idx) override
+        {
+            return this->locmgr_.pe_for(idx);
+        }
+
+        // invokes fn on each element that's local to this pe
+        template <typename Fn>
+        void for_each(const Fn& fn) const
+        {
+            this->chares_.for_each(fn);
         }
 
         void flush_buffers(const chare_index_t& idx)
@@ -95,24 +191,35 @@ namespace cmk {
             {
                 return;
             }
-            else
+            // only attempt the messages that are currently buffered since
+            // (e.g.) out-of-order broadcasts will be re-buffered
+            auto n_buffered = find->second.size();
+            for (decltype(n_buffered) i = 0; i < n_buffered; i++)
             {
+                // NOTE ( delivery may insert into buffers_, invalidating )
+                //      ( our iterators, so we search for it each time    )
                 auto& buffer = find->second;
-                while (!buffer.empty())
+                auto msg = std::move(buffer.front());
+                buffer.pop_front();
+                if (buffer.empty())
                 {
-                    auto& msg = buffer.front();
-                    if (this->try_deliver(msg))
-                    {
-                        // if successful, pop from the queue
-                        buffer.pop_front();
-                    }
-                    else
+                    this->buffers_.erase(find);
+                }
+                if (this->try_deliver(msg))
+                {
+                    find = this->buffers_.find(idx);
+                    if (find == std::end(this->buffers_))
                     {
-                        // if delivery failed, stop attempting
-                        // to deliver messages
-                        break;
+                        return;
                     }
                 }
+                else
+                {
+                    // if delivery failed, put the message back and
+                    // stop attempting to deliver messages
+                    this->buffers_[idx].emplace_front(std::move(msg));
+                    return;
+                }
             }
         }
 
@@ -122,6 +229,12 @@ namespace cmk {
             auto* rec = record_for(ep.entry);
             auto& idx = ep.chare;
             auto pe = this->locmgr_.pe_for(idx);
+            // messages for a pe are delivered to its leader (buffering
+            // them until the pe hosts an element)
+            if ((pe == CmiMyPe()) && !(this->locmgr_.resolve(idx)))
+            {
+                return false;
+            }
             // TODO ( temporary constraint, elements only created on home pe )
             if (rec->is_constructor_ && (pe == CmiMyPe()))
             {
@@ -130,17 +243,22 @@ namespace cmk {
                 property_setter_<T>()(ch, this->id_, idx);
                 // place the chare within our element list
                 auto ins = chares_.emplace(idx, ch);
-                CmiAssertMsg(ins.second, "insertion did not occur!");
+                CmiAssertMsg(ins, "insertion did not occur!");
+                this->locmgr_.on_insert(idx);
+                // (copied since the message is consumed)
+                auto elt = idx;
                 // call constructor on chare
                 rec->invoke(ch, std::move(msg));
                 // flush any messages we have for it
-                flush_buffers(idx);
+                flush_buffers(elt);
+                // (and for our pe if it's our first element)
+                flush_buffers(pe_root_index_(CmiMyPe()));
             }
             else
             {
-                auto find = chares_.find(idx);
+                auto* obj = chares_.find(idx);
                 // if the element isn't found locally
-                if (find == std::end(this->chares_))
+                if (obj == nullptr)
                 {
                     // and it's our chare...
                     if (pe == CmiMyPe())
@@ -158,7 +276,7 @@ namespace cmk {
                 else
                 {
                     // otherwise, invoke the EP on the chare
-                    handle_(rec, (find->second).get(), std::move(msg));
+                    handle_(rec, obj, std::move(msg));
                 }
             }
 
@@ -168,10 +286,32 @@ namespace cmk {
         inline void deliver_now(message_ptr<>&& msg)
         {
             auto& ep = msg->dst_.endpoint();
-            if (ep.chare == chare_bcast_root_)
+            if (msg->kind_ == message_helper_<scan_message_>::kind_)
+            {
+                this->handle_scan_message_(std::move(msg));
+            }
+            else if (msg->kind_ == message_helper_<gather_part_>::kind_)
+            {
+                this->handle_gather_part_(std::move(msg));
+            }
+            else if (msg->kind_ == message_helper_<section_message_>::kind_)
+            {
+                this->handle_section_message_(std::move(msg));
+            }
+            else if (msg->is_node_partial())
+            {
+                // child nodes' partials bypass this pe's elements
+                msg->is_node_partial() = false;
+                this->deposit_(std::move(msg));
+            }
+            else if (ep.chare == chare_bcast_root_)
             {
                 auto root = locmgr_.root();
-                auto* obj = static_cast<chare_base_*>(this->lookup(root));
+                auto local = (locmgr_.pe_for(root) == CmiMyPe()) &&
+                    locmgr_.resolve(root);
+                auto* obj = local ?
+                    static_cast<chare_base_*>(this->lookup(root)) :
+                    nullptr;
                 if (obj == nullptr)
                 {
                     // if the object is unavailable -- we have to reroute it
@@ -218,57 +358,313 @@ namespace cmk {
             auto& ep = msg->dst_.endpoint();
             auto& idx = ep.chare;
             auto* obj = static_cast<chare_base_*>(this->lookup(idx));
-            // stamp the message with a sequence number
-            ep.bcast = ++(obj->last_redn_);
-            this->handle_reduction_message_(obj, std::move(msg));
+            auto limit = CpvAccess(segment_size_);
+            if (limit && msg->is_array() &&
+                (msg->total_size_ > (limit + sizeof(message))))
+            {
+                // large arrays are reduced as a series of segments, each
+                // with its own sequence number, so they're pipelined
+                auto* hdr = array_header_for_(msg.get());
+                hdr->origin = this->id_;
+                hdr->base = obj->last_redn_ + 1;
+                auto n = std::max(limit / hdr->elem_size, (std::size_t) 1);
+                split_array_(std::move(msg), n, [&](message_ptr<>&& seg) {
+                    seg->dst_.endpoint().bcast = ++(obj->last_redn_);
+                    this->handle_reduction_message_(obj, std::move(seg));
+                });
+            }
+            else
+            {
+                // stamp the message with a sequence number
+                ep.bcast = ++(obj->last_redn_);
+                this->handle_reduction_message_(obj, std::move(msg));
+            }
+        }
+
+        // section reductions take the section's tree, with each pe combining
+        // the contributions of its members and children
+        virtual void contribute(
+            const section_index_t& sid, message_ptr<>&& msg) override
+        {
+            auto& sec = this->sections_[sid];
+            auto& ep = msg->dst_.endpoint();
+            // stamp the message with a (section-specific) sequence number
+            ep.bcast = ++(sec.last_redn[ep.chare]);
+            if (sec.described)
+            {
+                this->deposit_section_(sid, ep.bcast, std::move(msg));
+            }
+            else
+            {
+                sec.pending.emplace_back(std::move(msg));
+            }
+        }
+
+        virtual void barrier(
+            const chare_index_t& idx, const continuation_& cont) override
+        {
+            auto* obj = static_cast<chare_base_*>(this->lookup(idx));
+            // barriers are sequenced alongside reductions
+            this->arrive_(obj, ++(obj->last_redn_), cont);
+        }
+
+        // scans follow the order of pes, then that of the elements'
+        // indices on each pe (i.e., index order for groups)
+        virtual void scan(message_ptr<>&& msg, combiner_id_t comb,
+            bool inclusive) override
+        {
+            auto& ep = msg->dst_.endpoint();
+            auto idx = ep.chare;
+            auto* obj = static_cast<chare_base_*>(this->lookup(idx));
+            // scans are sequenced alongside reductions
+            auto seq = ++(obj->last_redn_);
+            auto& scan = this->get_scanner_(seq, comb, ep.entry, inclusive);
+            scan.locals.emplace_back(idx, std::move(msg));
+            this->sweep_up_(seq);
+        }
+
+        // each pe merges its elements' contributions with its children's
+        // (into one message, sized from theirs) then sends it up the tree,
+        // so the root receives one message per child and allocates the
+        // result exactly once
+        virtual void gather(message_ptr<>&& msg, message_kind_t kind,
+            const continuation_& cont) override
+        {
+            auto idx = msg->dst_.endpoint().chare;
+            auto* obj = static_cast<chare_base_*>(this->lookup(idx));
+            // gathers are sequenced alongside reductions
+            auto seq = ++(obj->last_redn_);
+            auto& gather = this->gathers_[seq];
+            gather.kind = kind;
+            gather.cont = cont;
+            gather.locals.emplace_back(idx, std::move(msg));
+            this->try_gather_(seq);
+        }
+
+        // each pe merges its elements' values for each pe into a single
+        // message (so pes exchange one message with each other) and those
+        // it receives into one message for each of its elements
+        virtual void all_to_all(message_ptr<>&& msg) override
+        {
+            auto idx = msg->dst_.endpoint().chare;
+            auto* obj = static_cast<chare_base_*>(this->lookup(idx));
+            // all-to-alls are sequenced alongside reductions
+            auto seq = ++(obj->last_redn_);
+            auto& exchange = this->exchanges_[seq];
+            exchange.locals.emplace_back(idx, std::move(msg));
+            if (exchange.locals.size() == this->locmgr_.n_locals())
+            {
+                this->send_exchange_(seq);
+            }
         }
 
     private:
         using reducer_iterator_t =
             typename chare_base_::reducer_map_t::iterator;
 
+        // folds msg into a reducer's partial result
+        static void combine_(reducer_& reducer, message_ptr<>&& msg)
+        {
+            auto& lhs = reducer.partial;
+            if (lhs && (*(msg->combiner()) == nil_combiner_))
+            {
+                // barriers have nothing to combine
+                message::free(msg);
+            }
+            else if (lhs)
+            {
+                auto comb = combiner_for(msg->dst_.endpoint().entry);
+                auto cont = *(msg->continuation());
+                // combine them by the given function
+                lhs = comb(std::move(lhs), std::move(msg));
+                // reset the message's continuation
+                // (in case it was overriden)
+                set_continuation_(lhs, cont);
+            }
+            else
+            {
+                lhs = std::move(msg);
+            }
+        }
+
+        // sends a reduction's result to its continuation
+        void finish_reduction_(message_ptr<>&& result)
+        {
+            // update result's destination and priority (and clear
+            // flags) so we can send it along
+            auto cont = *(result->continuation());
+            new (&(result->dst_)) destination(cont.dst);
+            if (cont.prio)
+            {
+                set_priority_(result, cont.prio);
+            }
+            result->has_combiner() = false;
+            clear_continuation_(result.get());
+            auto& dst = result->dst_;
+            auto fused = (dst.kind() == kEndpoint) &&
+                (dst.endpoint().collection == this->id_) &&
+                (dst.endpoint().chare == chare_bcast_root_);
+            if (result->is_segment() && (dst.kind() == kEndpoint))
+            {
+                // segments are joined by (our) converse handler, which
+                // then routes the whole result to its endpoint. they're
+                // joined at the tree root's pe since (with node reductions)
+                // each segment can finish on a different pe of its node
+                auto pe = this->locmgr_.pe_for(this->locmgr_.root());
+                send_helper_(pe, std::move(result));
+                return;
+            }
+            else if (!fused)
+            {
+                cmk::send(std::move(result));
+                return;
+            }
+            // results broadcast to our own elements (i.e., allreduces)
+            // fan out from the tree's root without leaving it, taking the
+            // reverse of the reduction's path
+            auto root = this->locmgr_.root();
+            auto pe = this->locmgr_.pe_for(root);
+            auto& depth = CpvAccess(inline_depth_);
+            if ((pe == CmiMyPe()) && (depth < CHARMLITE_MAX_INLINE_DEPTH))
+            {
+                depth++;
+                this->deliver_now(std::move(result));
+                depth--;
+            }
+            else
+            {
+                send_helper_(pe, std::move(result));
+            }
+        }
+
+        // combines a pe's (or a child node's) partial into this node's
+        // accumulator, forwarding the node's result once it's complete
+        void deposit_(message_ptr<>&& msg)
+        {
+            auto& node = this->locmgr_.node_tree();
+            if (this->accumulator_ == nullptr)
+            {
+                this->accumulator_ = node_reducer_for_(this->id_);
+            }
+            auto& reducers = this->accumulator_->reducers;
+            auto redn = msg->dst_.endpoint().bcast;
+            message_ptr<> result;
+            CmiLock(this->accumulator_->lock);
+            auto search = reducers.find(redn);
+            if (search == std::end(reducers))
+            {
+                // (reducers count themselves as a contributor)
+                search = reducers.emplace(redn, node.expected - 1).first;
+            }
+            auto& reducer = search->second;
+            combine_(reducer, std::move(msg));
+            if (++reducer.received == reducer.expected)
+            {
+                result = std::move(reducer.partial);
+                reducers.erase(search);
+            }
+            CmiUnlock(this->accumulator_->lock);
+            // the last contributor sends the node's result along
+            if (!result)
+            {
+                return;
+            }
+            else if (node.parent < 0)
+            {
+                finish_reduction_(std::move(result));
+            }
+            else
+            {
+                result->dst_.endpoint().chare =
+                    this->locmgr_.address_of(node.parent);
+                result->is_node_partial() = true;
+                send_helper_(node.parent, std::move(result));
+            }
+        }
+
         void handle_reduction_message_(chare_base_* obj, message_ptr<>&& msg)
         {
-            auto& ep = msg->dst_.endpoint();
-            auto& redn = ep.bcast;
-            auto search = this->get_reducer_(obj, redn);
+            auto search = this->get_reducer_(obj, msg->dst_.endpoint().bcast);
             auto& reducer = search->second;
-            reducer.received.emplace_back(std::move(msg));
+            combine_(reducer, std::move(msg));
             // when we've received all expected messages
-            if (reducer.ready())
-            {
-                auto comb = combiner_for(ep.entry);
-                auto& recvd = reducer.received;
-                auto& lhs = recvd.front();
-                for (auto it = std::begin(recvd) + 1; it != std::end(recvd);
-                     it++)
-                {
-                    auto& rhs = *it;
-                    auto cont = *(rhs->continuation());
-                    // combine them by the given function
-                    lhs = comb(std::move(lhs), std::move(rhs));
-                    // reset the message's continuation
-                    // (in case it was overriden)
-                    lhs->has_continuation() = true;
-                    new (lhs->continuation()) destination(cont);
-                }
-                // update result's destination (and clear
-                // flags) so we can send it along
-                auto& down = reducer.downstream;
-                if (down.empty())
-                {
-                    new (&(lhs->dst_)) destination(*(lhs->continuation()));
-                    lhs->has_combiner() = lhs->has_continuation() = false;
-                    cmk::send(std::move(lhs));
+            if (++reducer.received == reducer.expected)
+            {
+                auto result = std::move(reducer.partial);
+                // erase the reducer (it's job is done)
+                obj->reducers_.erase(search);
+                this->forward_reduction_(obj, std::move(result));
+            }
+        }
+
+        // counts a local element's arrival at a barrier, only creating a
+        // message once one has to leave this pe (or reach the callback)
+        void arrive_(
+            chare_base_* obj, bcast_id_t redn, const continuation_& cont)
+        {
+            auto search = this->get_reducer_(obj, redn);
+            auto& reducer = search->second;
+            if (++reducer.received < reducer.expected)
+            {
+                return;
+            }
+            auto result = std::move(reducer.partial);
+            obj->reducers_.erase(search);
+            auto& idx = obj->index_;
+            auto& down = this->locmgr_.downstream(idx);
+            auto local = !(this->locmgr_.combines_on_node() &&
+                             this->locmgr_.is_leader(idx)) &&
+                !down.empty() &&
+                (this->locmgr_.pe_for(down.front()) == CmiMyPe());
+            if (local && !result)
+            {
+                // non-leaders arrive directly at their (local) leader
+                auto* parent =
+                    static_cast<chare_base_*>(this->lookup(down.front()));
+                CmiAssert(parent != nullptr);
+                this->arrive_(parent, redn, cont);
+                return;
+            }
+            else if (!result)
+            {
+                result = cmk::make_message<message>();
+                new (&(result->dst_))
+                    destination(this->id_, idx, nil_combiner_);
+                result->dst_.endpoint().bcast = redn;
+                result->has_combiner() = true;
+                set_continuation_(result, cont);
+            }
+            this->forward_reduction_(obj, std::move(result));
+        }
+
+        // sends a completed partial down the tree (towards the root)
+        void forward_reduction_(chare_base_* obj, message_ptr<>&& result)
+        {
+            auto& down = this->locmgr_.downstream(obj->index_);
+            if (this->locmgr_.combines_on_node() &&
+                this->locmgr_.is_leader(obj->index_))
+            {
+                // pe-level results go to the node's accumulator
+                this->deposit_(std::move(result));
+            }
+            else if (down.empty())
+            {
+                finish_reduction_(std::move(result));
+            }
+            else
+            {
+                CmiAssert(down.size() == 1);
+                auto& parent = down.front();
+                result->dst_.endpoint().chare = parent;
+                // partials for (local) leaders are combined immediately
+                if (this->locmgr_.pe_for(parent) == CmiMyPe())
+                {
+                    this->deliver_now(std::move(result));
                 }
                 else
                 {
-                    CmiAssert(down.size() == 1);
-                    lhs->dst_.endpoint().chare = down.front();
-                    this->deliver_later(std::move(lhs));
+                    this->deliver_later(std::move(result));
                 }
-                // erase the reducer (it's job is done)
-                obj->reducers_.erase(search);
             }
         }
 
@@ -282,15 +678,36 @@ namespace cmk {
             if (bcast == (base->last_bcast_ + 1))
             {
                 base->last_bcast_++;
-                auto children = this->locmgr_.upstream(idx);
-                // ensure message is packed so we can safely clone it
-                pack_message(msg);
-                // send a copy of the message to all our children
+                auto& children = this->locmgr_.upstream(idx);
+                // retrieve the payload of shared messages
+                if (msg->kind_ == message_helper_<shared_message_>::kind_)
+                {
+                    msg = static_cast<shared_message_*>(msg.get())->release();
+                }
+                auto share = msg->is_shareable();
+                if (!share)
+                {
+                    // ensure message is packed so we can safely clone it
+                    pack_message(msg);
+                }
+                // send the message to all our children
                 for (auto& child : children)
                 {
-                    auto clone = msg->clone();
-                    clone->dst_.endpoint().chare = child;
-                    this->deliver_later(std::move(clone));
+                    auto pe = this->locmgr_.pe_for(child);
+                    message_ptr<> copy;
+                    if (share && (CmiNodeOf(pe) == CmiMyNode()))
+                    {
+                        // children on our node reference our copy (without
+                        // cloning it) through a lightweight envelope
+                        copy = cmk::make_message<shared_message_>(msg);
+                        new (&(copy->dst_)) destination(msg->dst_);
+                    }
+                    else
+                    {
+                        copy = msg->clone();
+                    }
+                    copy->dst_.endpoint().chare = child;
+                    this->deliver_later(std::move(copy));
                 }
                 // process the message locally
                 rec->invoke(obj, std::move(msg));
@@ -304,6 +721,708 @@ namespace cmk {
             }
         }
 
+        // combines two (possibly null) values, consuming them
+        static message_ptr<> combine_values_(
+            combiner_id_t comb, message_ptr<>&& lhs, message_ptr<>&& rhs)
+        {
+            if (!lhs)
+            {
+                return std::move(rhs);
+            }
+            else if (!rhs)
+            {
+                return std::move(lhs);
+            }
+            else
+            {
+                return combiner_for(comb)(std::move(lhs), std::move(rhs));
+            }
+        }
+
+        // copies a (possibly null) value
+        static message_ptr<> copy_value_(message_ptr<>& msg)
+        {
+            if (!msg)
+            {
+                return message_ptr<>();
+            }
+            pack_message(msg);
+            auto copy = msg->clone();
+            unpack_message(msg);
+            unpack_message(copy);
+            return copy;
+        }
+
+        scanner_& get_scanner_(bcast_id_t seq, combiner_id_t comb,
+            entry_id_t entry, bool inclusive)
+        {
+            auto find = this->scans_.find(seq);
+            if (find == std::end(this->scans_))
+            {
+                find = this->scans_.emplace(seq).first;
+                auto& scan = find->second;
+                scan.combiner = comb;
+                scan.entry = entry;
+                scan.inclusive = inclusive;
+                scan.uppers.resize(this->locmgr_.scan_children().size());
+            }
+            return find->second;
+        }
+
+        void send_scan_message_(int pe, message_ptr<scan_message_>&& msg)
+        {
+            new (&(msg->dst_)) destination(
+                this->id_, this->locmgr_.address_of(pe), msg->entry);
+            send_helper_(pe, std::move(msg));
+        }
+
+        void handle_scan_message_(message_ptr<>&& msg)
+        {
+            auto* env = static_cast<scan_message_*>(msg.get());
+            auto seq = env->seq;
+            auto& scan = this->get_scanner_(
+                seq, env->combiner, env->entry, env->inclusive);
+            if (env->upward)
+            {
+                auto& children = this->locmgr_.scan_children();
+                auto pos = std::find(std::begin(children), std::end(children),
+                               env->sender) -
+                    std::begin(children);
+                CmiAssert(pos < (std::ptrdiff_t) children.size());
+                scan.uppers[pos] = env->value();
+                scan.n_uppers++;
+                message::free(msg);
+                this->sweep_up_(seq);
+            }
+            else
+            {
+                scan.prefix = env->value();
+                scan.has_prefix = true;
+                message::free(msg);
+                this->sweep_down_(seq);
+            }
+        }
+
+        // once all of a pe's elements and children have contributed, sends
+        // the total of its subtree to its parent
+        void sweep_up_(bcast_id_t seq)
+        {
+            auto& scan = this->scans_.find(seq)->second;
+            auto& locals = scan.locals;
+            if (scan.swept_up || (locals.size() < this->locmgr_.n_locals()) ||
+                (scan.n_uppers < scan.uppers.size()))
+            {
+                return;
+            }
+            // compute the local (inclusive) prefixes in index order
+            std::sort(std::begin(locals), std::end(locals),
+                [](const std::pair<chare_index_t, message_ptr<>>& lhs,
+                    const std::pair<chare_index_t, message_ptr<>>& rhs) {
+                    return lhs.first < rhs.first;
+                });
+            for (std::size_t i = 1; i < locals.size(); i++)
+            {
+                locals[i].second = combine_values_(scan.combiner,
+                    copy_value_(locals[i - 1].second),
+                    std::move(locals[i].second));
+            }
+            scan.total = copy_value_(locals.back().second);
+            // then that of our subtree (children follow us in pe order)
+            auto subtotal = copy_value_(scan.total);
+            for (auto& upper : scan.uppers)
+            {
+                subtotal = combine_values_(
+                    scan.combiner, std::move(subtotal), copy_value_(upper));
+            }
+            scan.swept_up = true;
+            auto parent = this->locmgr_.scan_parent();
+            if (parent >= 0)
+            {
+                this->send_scan_message_(parent,
+                    scan_message_::make(seq, scan.combiner, scan.entry,
+                        scan.inclusive, true, std::move(subtotal)));
+            }
+            else
+            {
+                // nothing precedes the first pe
+                scan.has_prefix = true;
+                this->sweep_down_(seq);
+            }
+        }
+
+        // once a pe knows the prefix preceding it, sends its children theirs
+        // then delivers its elements' results
+        void sweep_down_(bcast_id_t seq)
+        {
+            auto search = this->scans_.find(seq);
+            auto& scan = search->second;
+            if (!(scan.swept_up && scan.has_prefix))
+            {
+                return;
+            }
+            auto& locals = scan.locals;
+            std::vector<message_ptr<>> results(locals.size());
+            for (std::size_t i = 0; i < locals.size(); i++)
+            {
+                auto prior = copy_value_(scan.prefix);
+                if (scan.inclusive)
+                {
+                    results[i] = combine_values_(scan.combiner,
+                        std::move(prior), std::move(locals[i].second));
+                }
+                else if (i > 0)
+                {
+                    results[i] = combine_values_(scan.combiner,
+                        std::move(prior), std::move(locals[i - 1].second));
+                }
+                else
+                {
+                    // ( this is null for the very first element )
+                    results[i] = std::move(prior);
+                }
+            }
+            auto& children = this->locmgr_.scan_children();
+            auto running = combine_values_(
+                scan.combiner, std::move(scan.prefix), std::move(scan.total));
+            for (std::size_t i = 0; i < children.size(); i++)
+            {
+                this->send_scan_message_(children[i],
+                    scan_message_::make(seq, scan.combiner, scan.entry,
+                        scan.inclusive, false, copy_value_(running)));
+                running = combine_values_(scan.combiner, std::move(running),
+                    std::move(scan.uppers[i]));
+            }
+            // the scan is done with, so (safely) deliver its results
+            auto entry = scan.entry;
+            std::vector<chare_index_t> indices;
+            for (auto& local : locals)
+            {
+                indices.emplace_back(local.first);
+            }
+            this->scans_.erase(search);
+            auto* rec = record_for(entry);
+            for (std::size_t i = 0; i < indices.size(); i++)
+            {
+                auto& idx = indices[i];
+                auto& result = results[i];
+                if (result)
+                {
+                    new (&(result->dst_)) destination(this->id_, idx, entry);
+                }
+                rec->invoke(this->lookup(idx), std::move(result));
+            }
+        }
+
+        // (gathers and scatters take the same tree as scans)
+        void send_gather_part_(int pe, message_ptr<>&& msg)
+        {
+            new (&(msg->dst_)) destination(
+                this->id_, this->locmgr_.address_of(pe), nil_entry_);
+            send_helper_(pe, std::move(msg));
+        }
+
+        void handle_gather_part_(message_ptr<>&& msg)
+        {
+            auto* hdr = gather_header_for_(msg.get());
+            auto pe = this->locmgr_.pe_for(this->locmgr_.root());
+            if (hdr->phase == kGatherPhase)
+            {
+                auto seq = hdr->seq;
+                this->gathers_[seq].parts.emplace_back(std::move(msg));
+                this->try_gather_(seq);
+            }
+            else if (hdr->phase == kExchangePhase)
+            {
+                auto seq = hdr->seq;
+                this->exchanges_[seq].parts.emplace_back(std::move(msg));
+                this->try_exchange_(seq);
+            }
+            else if ((msg->dst_.endpoint().chare == chare_bcast_root_) &&
+                (pe != CmiMyPe()))
+            {
+                // scatters start from the root of the tree
+                send_helper_(pe, std::move(msg));
+            }
+            else
+            {
+                this->scatter_(std::move(msg));
+            }
+        }
+
+        // once all of a pe's elements and children have contributed, merges
+        // their values (in index order) and sends them to its parent
+        void try_gather_(bcast_id_t seq)
+        {
+            auto search = this->gathers_.find(seq);
+            auto& gather = search->second;
+            auto& children = this->locmgr_.scan_children();
+            if (gather.locals.empty() ||
+                (gather.locals.size() < this->locmgr_.n_locals()) ||
+                (gather.parts.size() < children.size()))
+            {
+                return;
+            }
+            struct source_
+            {
+                chare_index_t index;
+                const char* values;
+                std::size_t count;
+            };
+            std::vector<source_> sources;
+            std::size_t n_values = 0;
+            gather_header_ proto{};
+            proto.kind = gather.kind;
+            for (auto& local : gather.locals)
+            {
+                auto* arr = array_header_for_(local.second.get());
+                auto* base = reinterpret_cast<char*>(local.second.get());
+                proto.elem_size = arr->elem_size;
+                proto.array_kind = local.second->kind_;
+                proto.array_offset = arr->offset;
+                sources.emplace_back(
+                    source_{local.first, base + arr->offset, arr->size});
+                n_values += arr->size;
+            }
+            for (auto& part : gather.parts)
+            {
+                auto* hdr = gather_header_for_(part.get());
+                auto* entries = gather_entries_(part.get());
+                auto* values = gather_values_(part.get());
+                for (std::size_t i = 0; i < hdr->n_entries; i++)
+                {
+                    auto& entry = entries[i];
+                    sources.emplace_back(source_{entry.index,
+                        values + entry.first * hdr->elem_size, entry.count});
+                }
+                n_values += hdr->n_values;
+            }
+            std::sort(std::begin(sources), std::end(sources),
+                [](const source_& lhs, const source_& rhs) {
+                    return lhs.index < rhs.index;
+                });
+            // allocate the merged message once, now that its size is known
+            auto parent = this->locmgr_.scan_parent();
+            auto kind = (parent >= 0) ? message_helper_<gather_part_>::kind_ :
+                                        gather.kind;
+            auto merged = make_gather_(kind, proto, sources.size(), n_values);
+            for (auto& source : sources)
+            {
+                gather_append_(
+                    merged.get(), source.index, source.values, source.count);
+            }
+            auto cont = gather.cont;
+            // (this frees the contributions)
+            this->gathers_.erase(search);
+            if (parent >= 0)
+            {
+                auto* hdr = gather_header_for_(merged.get());
+                hdr->seq = seq;
+                hdr->phase = kGatherPhase;
+                this->send_gather_part_(parent, std::move(merged));
+            }
+            else
+            {
+                new (&(merged->dst_)) destination(cont.dst);
+                if (cont.prio)
+                {
+                    set_priority_(merged, cont.prio);
+                }
+                cmk::send(std::move(merged));
+            }
+        }
+
+        // delivers the values of this pe's elements, and forwards those of
+        // each child's subtree to it (as one message)
+        void scatter_(message_ptr<>&& msg)
+        {
+            auto* hdr = gather_header_for_(msg.get());
+            auto* entries = gather_entries_(msg.get());
+            auto* values = gather_values_(msg.get());
+            auto& children = this->locmgr_.scan_children();
+            auto n_children = children.size();
+            // subtrees span contiguous ranges of pes, so an entry belongs to
+            // the last child that doesn't follow its pe (or to us)
+            std::vector<std::size_t> owners(hdr->n_entries, n_children);
+            std::vector<std::size_t> n_entries(n_children, 0);
+            std::vector<std::size_t> n_values(n_children, 0);
+            for (std::size_t i = 0; i < hdr->n_entries; i++)
+            {
+                auto pe = this->locmgr_.pe_for(entries[i].index);
+                if (pe != CmiMyPe())
+                {
+                    auto pos = std::upper_bound(
+                        std::begin(children), std::end(children), pe);
+                    CmiAssertMsg(pos != std::begin(children),
+                        "scattered to an element outside of the tree");
+                    auto child = (std::size_t)(pos - std::begin(children)) - 1;
+                    owners[i] = child;
+                    n_entries[child]++;
+                    n_values[child] += entries[i].count;
+                }
+            }
+            std::vector<message_ptr<>> parts(n_children);
+            for (std::size_t i = 0; i < n_children; i++)
+            {
+                if (n_entries[i] > 0)
+                {
+                    parts[i] =
+                        make_gather_(message_helper_<gather_part_>::kind_,
+                            *hdr, n_entries[i], n_values[i]);
+                }
+            }
+            std::vector<message_ptr<>> locals;
+            for (std::size_t i = 0; i < hdr->n_entries; i++)
+            {
+                auto& entry = entries[i];
+                auto* src = values + entry.first * hdr->elem_size;
+                if (owners[i] < n_children)
+                {
+                    gather_append_(
+                        parts[owners[i]].get(), entry.index, src, entry.count);
+                }
+                else
+                {
+                    auto arr = make_array_(hdr->array_kind, hdr->array_offset,
+                        hdr->elem_size, entry.count);
+                    std::memcpy(reinterpret_cast<char*>(arr.get()) +
+                            hdr->array_offset,
+                        src, entry.count * hdr->elem_size);
+                    new (&(arr->dst_))
+                        destination(this->id_, entry.index, hdr->entry);
+                    locals.emplace_back(std::move(arr));
+                }
+            }
+            message::free(msg);
+            for (std::size_t i = 0; i < n_children; i++)
+            {
+                if (parts[i])
+                {
+                    this->send_gather_part_(children[i], std::move(parts[i]));
+                }
+            }
+            for (auto& local : locals)
+            {
+                this->deliver_now(std::move(local));
+            }
+        }
+
+        // sends each pe the values of our elements for its elements
+        void send_exchange_(bcast_id_t seq)
+        {
+            auto& pes = this->locmgr_.pes();
+            auto& locals = this->exchanges_.find(seq)->second.locals;
+            auto* first = gather_header_for_(locals.front().second.get());
+            // count the entries (and values) bound for each pe
+            std::vector<std::size_t> n_entries(pes.size(), 0);
+            std::vector<std::size_t> n_values(pes.size(), 0);
+            std::vector<std::size_t> owners;
+            for (auto& local : locals)
+            {
+                auto* hdr = gather_header_for_(local.second.get());
+                auto* entries = gather_entries_(local.second.get());
+                for (std::size_t i = 0; i < hdr->n_entries; i++)
+                {
+                    auto pe = this->locmgr_.pe_for(entries[i].index);
+                    auto pos = std::lower_bound(
+                        std::begin(pes), std::end(pes), pe);
+                    CmiAssertMsg((pos != std::end(pes)) && (*pos == pe),
+                        "sent values to an element outside of the tree");
+                    auto owner = (std::size_t)(pos - std::begin(pes));
+                    owners.emplace_back(owner);
+                    n_entries[owner]++;
+                    n_values[owner] += entries[i].count;
+                }
+            }
+            // then allocate each pe's part once (even when it's empty,
+            // since pes count the parts they receive)
+            std::vector<message_ptr<>> parts(pes.size());
+            for (std::size_t i = 0; i < pes.size(); i++)
+            {
+                parts[i] = make_gather_(message_helper_<gather_part_>::kind_,
+                    *first, n_entries[i], n_values[i]);
+                auto* hdr = gather_header_for_(parts[i].get());
+                hdr->seq = seq;
+                hdr->phase = kExchangePhase;
+            }
+            auto owner = std::begin(owners);
+            for (auto& local : locals)
+            {
+                auto* hdr = gather_header_for_(local.second.get());
+                auto* entries = gather_entries_(local.second.get());
+                auto* values = gather_values_(local.second.get());
+                for (std::size_t i = 0; i < hdr->n_entries; i++)
+                {
+                    auto& entry = entries[i];
+                    gather_append_(parts[*(owner++)].get(), entry.index,
+                        values + entry.first * hdr->elem_size, entry.count,
+                        local.first);
+                }
+            }
+            auto& exchange = this->exchanges_.find(seq)->second;
+            exchange.locals.clear();
+            exchange.sent = true;
+            for (std::size_t i = 0; i < pes.size(); i++)
+            {
+                if (pes[i] == CmiMyPe())
+                {
+                    exchange.parts.emplace_back(std::move(parts[i]));
+                }
+                else
+                {
+                    this->send_gather_part_(pes[i], std::move(parts[i]));
+                }
+            }
+            this->try_exchange_(seq);
+        }
+
+        // once our elements' values were sent and every pe's arrived,
+        // delivers each of our elements its values (in order of their
+        // sources' indices)
+        void try_exchange_(bcast_id_t seq)
+        {
+            auto search = this->exchanges_.find(seq);
+            auto& exchange = search->second;
+            auto& parts = exchange.parts;
+            if (!exchange.sent || (parts.size() < this->locmgr_.pes().size()))
+            {
+                return;
+            }
+            struct source_
+            {
+                chare_index_t index;
+                chare_index_t peer;
+                const char* values;
+                std::size_t count;
+            };
+            std::vector<source_> sources;
+            for (auto& part : parts)
+            {
+                auto* hdr = gather_header_for_(part.get());
+                auto* entries = gather_entries_(part.get());
+                auto* values = gather_values_(part.get());
+                for (std::size_t i = 0; i < hdr->n_entries; i++)
+                {
+                    auto& entry = entries[i];
+                    sources.emplace_back(source_{entry.index, entry.peer,
+                        values + entry.first * hdr->elem_size, entry.count});
+                }
+            }
+            std::sort(std::begin(sources), std::end(sources),
+                [](const source_& lhs, const source_& rhs) {
+                    return (lhs.index < rhs.index) ||
+                        ((lhs.index == rhs.index) && (lhs.peer < rhs.peer));
+                });
+            // every local element receives a message (even an empty one)
+            std::vector<chare_index_t> targets;
+            this->chares_.for_each([&](T* obj) {
+                targets.emplace_back(static_cast<chare_base_*>(obj)->index_);
+            });
+            for (auto& source : sources)
+            {
+                if (targets.empty() || (targets.back() != source.index))
+                {
+                    targets.emplace_back(source.index);
+                }
+            }
+            std::sort(std::begin(targets), std::end(targets));
+            targets.erase(std::unique(std::begin(targets), std::end(targets)),
+                std::end(targets));
+            std::vector<message_ptr<>> results;
+            auto& proto = *gather_header_for_(parts.front().get());
+            auto it = std::begin(sources);
+            for (auto& target : targets)
+            {
+                // find the run of sources for this element
+                auto last = it;
+                std::size_t n_values = 0;
+                while ((last != std::end(sources)) && (last->index == target))
+                {
+                    n_values += (last++)->count;
+                }
+                auto result = make_gather_(proto.kind, proto,
+                    (std::size_t)(last - it), n_values);
+                for (; it != last; it++)
+                {
+                    gather_append_(result.get(), it->peer, it->values,
+                        it->count, target);
+                }
+                new (&(result->dst_))
+                    destination(this->id_, target, proto.entry);
+                results.emplace_back(std::move(result));
+            }
+            // the exchange is done with, so (safely) deliver its results
+            this->exchanges_.erase(search);
+            for (auto& result : results)
+            {
+                this->deliver_now(std::move(result));
+            }
+        }
+
+        void send_section_message_(int pe, message_ptr<>&& msg)
+        {
+            new (&(msg->dst_)) destination(
+                this->id_, this->locmgr_.address_of(pe), nil_entry_);
+            send_helper_(pe, std::move(msg));
+        }
+
+        void handle_section_message_(message_ptr<>&& msg)
+        {
+            auto* env = static_cast<section_message_*>(msg.get());
+            auto sid = env->section;
+            auto& sec = this->sections_[sid];
+            if (env->kind == kSectionDescribe)
+            {
+                this->describe_section_(std::move(msg));
+            }
+            else if (!sec.described)
+            {
+                // (messages can overtake the section's description)
+                sec.pending.emplace_back(std::move(msg));
+            }
+            else if (env->kind == kSectionMulticast)
+            {
+                this->multicast_(std::move(msg));
+            }
+            else
+            {
+                auto seq = env->seq;
+                auto value = env->value();
+                message::free(msg);
+                this->deposit_section_(sid, seq, std::move(value));
+            }
+        }
+
+        // caches this pe's part of a section's tree given the members of its
+        // subtree, then describes its children's subtrees to them
+        void describe_section_(message_ptr<>&& msg)
+        {
+            auto* env = static_cast<section_message_*>(msg.get());
+            auto sid = env->section;
+            auto* members = env->members();
+            auto n_members = env->n_members;
+            // the subtree's pes are ours, then the others (in order)
+            std::vector<int> owners(n_members);
+            std::vector<int> pes;
+            for (std::size_t i = 0; i < n_members; i++)
+            {
+                owners[i] = this->locmgr_.pe_for(members[i]);
+                if (owners[i] != CmiMyPe())
+                {
+                    pes.emplace_back(owners[i]);
+                }
+            }
+            std::sort(std::begin(pes), std::end(pes));
+            pes.erase(
+                std::unique(std::begin(pes), std::end(pes)), std::end(pes));
+            pes.insert(std::begin(pes), CmiMyPe());
+            auto& sec = this->sections_[sid];
+            int parent;
+            sec.parent = (env->sender == CmiMyPe()) ? -1 : env->sender;
+            build_tree_(tree_shape::binomial(), pes, CmiMyPe(), parent,
+                sec.children);
+            // binomial subtrees span contiguous ranges of pes, so a member
+            // belongs to the last child that doesn't follow its pe (or to us)
+            auto& children = sec.children;
+            std::vector<std::vector<chare_index_t>> subtrees(children.size());
+            for (std::size_t i = 0; i < n_members; i++)
+            {
+                if (owners[i] == CmiMyPe())
+                {
+                    sec.locals.emplace_back(members[i]);
+                }
+                else
+                {
+                    auto pos = std::upper_bound(
+                        std::begin(children), std::end(children), owners[i]);
+                    subtrees[pos - std::begin(children) - 1].emplace_back(
+                        members[i]);
+                }
+            }
+            CmiAssertMsg(!(sec.locals.empty() && children.empty()),
+                "sections must have members");
+            for (std::size_t i = 0; i < children.size(); i++)
+            {
+                auto& subtree = subtrees[i];
+                this->send_section_message_(children[i],
+                    section_message_::make(sid, kSectionDescribe,
+                        subtree.data(), subtree.size(), message_ptr<>()));
+            }
+            message::free(msg);
+            sec.described = true;
+            // then handle the messages that were waiting on it
+            auto pending = std::move(sec.pending);
+            for (auto& waiting : pending)
+            {
+                if (waiting->kind_ == message_helper_<section_message_>::kind_)
+                {
+                    this->handle_section_message_(std::move(waiting));
+                }
+                else
+                {
+                    auto seq = waiting->dst_.endpoint().bcast;
+                    this->deposit_section_(sid, seq, std::move(waiting));
+                }
+            }
+        }
+
+        // forwards a multicast to our children, then delivers (a copy of)
+        // its value to each of our members
+        void multicast_(message_ptr<>&& msg)
+        {
+            auto* env = static_cast<section_message_*>(msg.get());
+            auto& sec = this->sections_[env->section];
+            for (auto& child : sec.children)
+            {
+                this->send_section_message_(child, msg->clone());
+            }
+            std::vector<message_ptr<>> values;
+            for (auto& idx : sec.locals)
+            {
+                auto value = env->value();
+                new (&(value->dst_)) destination(this->id_, idx, env->entry);
+                values.emplace_back(std::move(value));
+            }
+            message::free(msg);
+            for (auto& value : values)
+            {
+                this->deliver_now(std::move(value));
+            }
+        }
+
+        // combines a member's contribution (or a child's partial) into its
+        // reduction, sending it up the tree once it's complete
+        void deposit_section_(
+            const section_index_t& sid, bcast_id_t seq, message_ptr<>&& msg)
+        {
+            auto& sec = this->sections_.find(sid)->second;
+            auto search = sec.reducers.find(seq);
+            if (search == std::end(sec.reducers))
+            {
+                // (reducers count themselves as a contributor)
+                auto n = sec.locals.size() + sec.children.size();
+                search = sec.reducers.emplace(seq, n - 1).first;
+            }
+            auto& reducer = search->second;
+            combine_(reducer, std::move(msg));
+            if (++reducer.received < reducer.expected)
+            {
+                return;
+            }
+            auto result = std::move(reducer.partial);
+            sec.reducers.erase(search);
+            if (sec.parent >= 0)
+            {
+                auto env = section_message_::make(
+                    sid, kSectionReduce, nullptr, 0, std::move(result));
+                env->seq = seq;
+                this->send_section_message_(sec.parent, std::move(env));
+            }
+            else
+            {
+                this->finish_reduction_(std::move(result));
+            }
+        }
+
         // get a chare's reducer, creating one if it doesn't already exist
         reducer_iterator_t get_reducer_(chare_base_* obj, bcast_id_t redn)
         {
@@ -311,14 +1430,13 @@ namespace cmk {
             auto find = reducers.find(redn);
             if (find == std::end(reducers))
             {
-                auto& idx = obj->index_;
                 // construct using most up-to-date knowledge of spanning tree
-                auto up = this->locmgr_.upstream(idx);
-                auto down = this->locmgr_.downstream(idx);
-                auto ins = reducers.emplace(std::piecewise_construct,
-                    std::forward_as_tuple(idx),
-                    std::forward_as_tuple(std::move(up), std::move(down)));
-                find = ins.first;
+                // ( only local elements contribute when combining on-node )
+                auto& idx = obj->index_;
+                auto n_children = this->locmgr_.combines_on_node() ?
+                    this->locmgr_.local_upstream(idx) :
+                    this->locmgr_.upstream(idx).size();
+                find = reducers.emplace(redn, n_children).first;
             }
             return find;
         }
@@ -0,0 +1,583 @@
+#ifndef __CMK_COMBINERS_HH__
+#define __CMK_COMBINERS_HH__
+
+#include "message.hh"
+
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+// asks the compiler to vectorize the loop that follows (which it only
+// does with optimizations enabled, hence the explicit kernels below)
+#if defined(__clang__)
+#define CMK_VECTORIZE_ _Pragma("clang loop vectorize(enable) interleave(enable)")
+#elif defined(__GNUC__)
+#define CMK_VECTORIZE_ _Pragma("GCC ivdep")
+#else
+#define CMK_VECTORIZE_
+#endif
+
+namespace cmk {
+    // a value tagged with its origin (e.g., an element's index)
+    // used by the argmin/argmax combiners to break ties
+    template <typename T, typename Index = std::int64_t>
+    struct indexed
+    {
+        T value;
+        Index index;
+    };
+
+    // exposes a message's payload as a contiguous array to reduce over
+    template <typename Message>
+    struct reduction_view_;
+
+    template <typename T>
+    struct reduction_view_<data_message<T>>
+    {
+        using type = T;
+
+        static T* data(data_message<T>& msg)
+        {
+            return &(msg.value());
+        }
+
+        static std::size_t size(const data_message<T>&)
+        {
+            return 1;
+        }
+    };
+
+    template <typename T, std::size_t N>
+    struct reduction_view_<data_message<std::array<T, N>>>
+    {
+        using type = T;
+
+        static T* data(data_message<std::array<T, N>>& msg)
+        {
+            return (msg.value()).data();
+        }
+
+        static std::size_t size(const data_message<std::array<T, N>>&)
+        {
+            return N;
+        }
+    };
+
+    template <typename T>
+    struct reduction_view_<array_message<T>>
+    {
+        using type = T;
+
+        static T* data(array_message<T>& msg)
+        {
+            return msg.data();
+        }
+
+        static std::size_t size(const array_message<T>& msg)
+        {
+            return msg.size();
+        }
+    };
+
+    // element-wise operators (written branch-free so they vectorize)
+    struct sum_op_
+    {
+        template <typename T>
+        static T apply(const T& lhs, const T& rhs)
+        {
+            return lhs + rhs;
+        }
+
+        template <typename V>
+        static auto vapply(const typename V::reg& lhs,
+            const typename V::reg& rhs) -> decltype(V::add(lhs, rhs))
+        {
+            return V::add(lhs, rhs);
+        }
+    };
+
+    struct prod_op_
+    {
+        template <typename T>
+        static T apply(const T& lhs, const T& rhs)
+        {
+            return lhs * rhs;
+        }
+
+        template <typename V>
+        static auto vapply(const typename V::reg& lhs,
+            const typename V::reg& rhs) -> decltype(V::mul(lhs, rhs))
+        {
+            return V::mul(lhs, rhs);
+        }
+    };
+
+    struct min_op_
+    {
+        template <typename T>
+        static T apply(const T& lhs, const T& rhs)
+        {
+            return (rhs < lhs) ? rhs : lhs;
+        }
+
+        template <typename V>
+        static auto vapply(const typename V::reg& lhs,
+            const typename V::reg& rhs) -> decltype(V::min(rhs, lhs))
+        {
+            return V::min(rhs, lhs);
+        }
+    };
+
+    struct max_op_
+    {
+        template <typename T>
+        static T apply(const T& lhs, const T& rhs)
+        {
+            return (lhs < rhs) ? rhs : lhs;
+        }
+
+        template <typename V>
+        static auto vapply(const typename V::reg& lhs,
+            const typename V::reg& rhs) -> decltype(V::max(rhs, lhs))
+        {
+            return V::max(rhs, lhs);
+        }
+    };
+
+    struct logical_and_op_
+    {
+        template <typename T>
+        static T apply(const T& lhs, const T& rhs)
+        {
+            return (T) (lhs && rhs);
+        }
+    };
+
+    struct logical_or_op_
+    {
+        template <typename T>
+        static T apply(const T& lhs, const T& rhs)
+        {
+            return (T) (lhs || rhs);
+        }
+    };
+
+    struct bit_and_op_
+    {
+        template <typename T>
+        static T apply(const T& lhs, const T& rhs)
+        {
+            return lhs & rhs;
+        }
+
+        template <typename V>
+        static auto vapply(const typename V::reg& lhs,
+            const typename V::reg& rhs) -> decltype(V::bit_and(lhs, rhs))
+        {
+            return V::bit_and(lhs, rhs);
+        }
+    };
+
+    struct bit_or_op_
+    {
+        template <typename T>
+        static T apply(const T& lhs, const T& rhs)
+        {
+            return lhs | rhs;
+        }
+
+        template <typename V>
+        static auto vapply(const typename V::reg& lhs,
+            const typename V::reg& rhs) -> decltype(V::bit_or(lhs, rhs))
+        {
+            return V::bit_or(lhs, rhs);
+        }
+    };
+
+    // (ties go to the lower index, so results are deterministic)
+    struct argmin_op_
+    {
+        template <typename T, typename Index>
+        static indexed<T, Index> apply(
+            const indexed<T, Index>& lhs, const indexed<T, Index>& rhs)
+        {
+            auto take = (rhs.value < lhs.value) ||
+                (!(lhs.value < rhs.value) && (rhs.index < lhs.index));
+            return take ? rhs : lhs;
+        }
+    };
+
+    struct argmax_op_
+    {
+        template <typename T, typename Index>
+        static indexed<T, Index> apply(
+            const indexed<T, Index>& lhs, const indexed<T, Index>& rhs)
+        {
+            auto take = (lhs.value < rhs.value) ||
+                (!(rhs.value < lhs.value) && (rhs.index < lhs.index));
+            return take ? rhs : lhs;
+        }
+    };
+
+    // the vector registers (and instructions) for each element type,
+    // picked by the widest instruction set the build targets. operations
+    // an instruction set lacks are left out, so they fall back to scalar
+    template <typename T, typename Enable = void>
+    struct simd_
+    {
+    };
+
+    // (defines one of a simd_'s operations by its intrinsic)
+#define CMK_SIMD_OP_(name, intrinsic)                                          \
+    static reg name(const reg& a, const reg& b)                                \
+    {                                                                          \
+        return intrinsic(a, b);                                                \
+    }
+
+    template <typename T, std::size_t Size, bool Signed>
+    using if_int_ = typename std::enable_if<std::is_integral<T>::value &&
+        !std::is_same<T, bool>::value && (sizeof(T) == Size) &&
+        (std::is_signed<T>::value == Signed)>::type;
+
+#if defined(__AVX__)
+    template <>
+    struct simd_<float>
+    {
+        using reg = __m256;
+        static constexpr std::size_t width = 8;
+
+        static reg load(const float* p)
+        {
+            return _mm256_loadu_ps(p);
+        }
+
+        static void store(float* p, const reg& v)
+        {
+            _mm256_storeu_ps(p, v);
+        }
+
+        CMK_SIMD_OP_(add, _mm256_add_ps)
+        CMK_SIMD_OP_(mul, _mm256_mul_ps)
+        CMK_SIMD_OP_(min, _mm256_min_ps)
+        CMK_SIMD_OP_(max, _mm256_max_ps)
+    };
+
+    template <>
+    struct simd_<double>
+    {
+        using reg = __m256d;
+        static constexpr std::size_t width = 4;
+
+        static reg load(const double* p)
+        {
+            return _mm256_loadu_pd(p);
+        }
+
+        static void store(double* p, const reg& v)
+        {
+            _mm256_storeu_pd(p, v);
+        }
+
+        CMK_SIMD_OP_(add, _mm256_add_pd)
+        CMK_SIMD_OP_(mul, _mm256_mul_pd)
+        CMK_SIMD_OP_(min, _mm256_min_pd)
+        CMK_SIMD_OP_(max, _mm256_max_pd)
+    };
+#elif defined(__SSE2__)
+    template <>
+    struct simd_<float>
+    {
+        using reg = __m128;
+        static constexpr std::size_t width = 4;
+
+        static reg load(const float* p)
+        {
+            return _mm_loadu_ps(p);
+        }
+
+        static void store(float* p, const reg& v)
+        {
+            _mm_storeu_ps(p, v);
+        }
+
+        CMK_SIMD_OP_(add, _mm_add_ps)
+        CMK_SIMD_OP_(mul, _mm_mul_ps)
+        CMK_SIMD_OP_(min, _mm_min_ps)
+        CMK_SIMD_OP_(max, _mm_max_ps)
+    };
+
+    template <>
+    struct simd_<double>
+    {
+        using reg = __m128d;
+        static constexpr std::size_t width = 2;
+
+        static reg load(const double* p)
+        {
+            return _mm_loadu_pd(p);
+        }
+
+        static void store(double* p, const reg& v)
+        {
+            _mm_storeu_pd(p, v);
+        }
+
+        CMK_SIMD_OP_(add, _mm_add_pd)
+        CMK_SIMD_OP_(mul, _mm_mul_pd)
+        CMK_SIMD_OP_(min, _mm_min_pd)
+        CMK_SIMD_OP_(max, _mm_max_pd)
+    };
+#endif
+
+#if defined(__AVX2__)
+    // (the integer operations shared by each width)
+    template <typename T>
+    struct simd_int_
+    {
+        using reg = __m256i;
+        static constexpr std::size_t width = sizeof(reg) / sizeof(T);
+
+        static reg load(const T* p)
+        {
+            return _mm256_loadu_si256(reinterpret_cast<const reg*>(p));
+        }
+
+        static void store(T* p, const reg& v)
+        {
+            _mm256_storeu_si256(reinterpret_cast<reg*>(p), v);
+        }
+
+        CMK_SIMD_OP_(bit_and, _mm256_and_si256)
+
+        CMK_SIMD_OP_(bit_or, _mm256_or_si256)
+    };
+
+    template <typename T>
+    struct simd_<T, if_int_<T, 4, true>> : public simd_int_<T>
+    {
+        using reg = __m256i;
+
+        CMK_SIMD_OP_(add, _mm256_add_epi32)
+        CMK_SIMD_OP_(mul, _mm256_mullo_epi32)
+        CMK_SIMD_OP_(min, _mm256_min_epi32)
+        CMK_SIMD_OP_(max, _mm256_max_epi32)
+    };
+
+    template <typename T>
+    struct simd_<T, if_int_<T, 4, false>> : public simd_int_<T>
+    {
+        using reg = __m256i;
+
+        CMK_SIMD_OP_(add, _mm256_add_epi32)
+        CMK_SIMD_OP_(mul, _mm256_mullo_epi32)
+        CMK_SIMD_OP_(min, _mm256_min_epu32)
+        CMK_SIMD_OP_(max, _mm256_max_epu32)
+    };
+
+    template <typename T>
+    struct simd_<T, if_int_<T, 8, true>> : public simd_int_<T>
+    {
+        using reg = __m256i;
+
+        CMK_SIMD_OP_(add, _mm256_add_epi64)
+    };
+
+    template <typename T>
+    struct simd_<T, if_int_<T, 8, false>> : public simd_int_<T>
+    {
+        using reg = __m256i;
+
+        CMK_SIMD_OP_(add, _mm256_add_epi64)
+    };
+#elif defined(__SSE2__)
+    template <typename T>
+    struct simd_int_
+    {
+        using reg = __m128i;
+        static constexpr std::size_t width = sizeof(reg) / sizeof(T);
+
+        static reg load(const T* p)
+        {
+            return _mm_loadu_si128(reinterpret_cast<const reg*>(p));
+        }
+
+        static void store(T* p, const reg& v)
+        {
+            _mm_storeu_si128(reinterpret_cast<reg*>(p), v);
+        }
+
+        CMK_SIMD_OP_(bit_and, _mm_and_si128)
+
+        CMK_SIMD_OP_(bit_or, _mm_or_si128)
+    };
+
+    template <typename T>
+    struct simd_<T, if_int_<T, 4, true>> : public simd_int_<T>
+    {
+        using reg = __m128i;
+
+        CMK_SIMD_OP_(add, _mm_add_epi32)
+    };
+
+    template <typename T>
+    struct simd_<T, if_int_<T, 8, true>> : public simd_int_<T>
+    {
+        using reg = __m128i;
+
+        CMK_SIMD_OP_(add, _mm_add_epi64)
+    };
+
+    // (wrapping addition is the same for unsigned integers)
+    template <typename T>
+    struct simd_<T, if_int_<T, 4, false>> : public simd_int_<T>
+    {
+        using reg = __m128i;
+
+        CMK_SIMD_OP_(add, _mm_add_epi32)
+    };
+
+    template <typename T>
+    struct simd_<T, if_int_<T, 8, false>> : public simd_int_<T>
+    {
+        using reg = __m128i;
+
+        CMK_SIMD_OP_(add, _mm_add_epi64)
+    };
+#endif
+
+#undef CMK_SIMD_OP_
+
+    // folds the leading (whole) vectors of rhs into lhs, returning the
+    // number of elements it got through (zero when Op isn't vectorized
+    // for T)
+    template <typename Op, typename T, typename Enable = void>
+    struct simd_kernel_
+    {
+        static std::size_t apply(T*, const T*, std::size_t)
+        {
+            return 0;
+        }
+    };
+
+    template <typename Op, typename T>
+    struct simd_kernel_<Op, T,
+        decltype((void) Op::template vapply<simd_<T>>(
+            std::declval<typename simd_<T>::reg>(),
+            std::declval<typename simd_<T>::reg>()))>
+    {
+        static std::size_t apply(
+            T* __restrict__ lhs, const T* __restrict__ rhs, std::size_t n)
+        {
+            using vector_type = simd_<T>;
+            constexpr auto width = vector_type::width;
+            auto m = n - (n % width);
+            for (std::size_t i = 0; i < m; i += width)
+            {
+                auto v = Op::template vapply<vector_type>(
+                    vector_type::load(lhs + i), vector_type::load(rhs + i));
+                vector_type::store(lhs + i, v);
+            }
+            return m;
+        }
+    };
+
+    // folds rhs into lhs, element-wise
+    template <typename Op, typename T>
+    inline void reduce_n_(
+        T* __restrict__ lhs, const T* __restrict__ rhs, std::size_t n)
+    {
+        auto first = simd_kernel_<Op, T>::apply(lhs, rhs, n);
+        CMK_VECTORIZE_
+        for (std::size_t i = first; i < n; i++)
+        {
+            lhs[i] = Op::apply(lhs[i], rhs[i]);
+        }
+    }
+
+    template <typename Op, typename Message>
+    inline message_ptr<Message> reduce_with_(
+        message_ptr<Message>&& lhs, message_ptr<Message>&& rhs)
+    {
+        using view_type = reduction_view_<Message>;
+        auto n = view_type::size(*lhs);
+        CmiAssertMsg(n == view_type::size(*rhs),
+            "contributions must have the same number of elements");
+        reduce_n_<Op>(view_type::data(*lhs), view_type::data(*rhs), n);
+        return std::move(lhs);
+    }
+
+    // built-in combiners for data_message<T>, data_message<std::array<T, N>>
+    // and array_message<T>, e.g., cmk::sum<cmk::array_message<double>>
+    template <typename Message>
+    message_ptr<Message> sum(
+        message_ptr<Message>&& lhs, message_ptr<Message>&& rhs)
+    {
+        return reduce_with_<sum_op_>(std::move(lhs), std::move(rhs));
+    }
+
+    template <typename Message>
+    message_ptr<Message> prod(
+        message_ptr<Message>&& lhs, message_ptr<Message>&& rhs)
+    {
+        return reduce_with_<prod_op_>(std::move(lhs), std::move(rhs));
+    }
+
+    template <typename Message>
+    message_ptr<Message> min(
+        message_ptr<Message>&& lhs, message_ptr<Message>&& rhs)
+    {
+        return reduce_with_<min_op_>(std::move(lhs), std::move(rhs));
+    }
+
+    template <typename Message>
+    message_ptr<Message> max(
+        message_ptr<Message>&& lhs, message_ptr<Message>&& rhs)
+    {
+        return reduce_with_<max_op_>(std::move(lhs), std::move(rhs));
+    }
+
+    template <typename Message>
+    message_ptr<Message> logical_and(
+        message_ptr<Message>&& lhs, message_ptr<Message>&& rhs)
+    {
+        return reduce_with_<logical_and_op_>(std::move(lhs), std::move(rhs));
+    }
+
+    template <typename Message>
+    message_ptr<Message> logical_or(
+        message_ptr<Message>&& lhs, message_ptr<Message>&& rhs)
+    {
+        return reduce_with_<logical_or_op_>(std::move(lhs), std::move(rhs));
+    }
+
+    template <typename Message>
+    message_ptr<Message> bit_and(
+        message_ptr<Message>&& lhs, message_ptr<Message>&& rhs)
+    {
+        return reduce_with_<bit_and_op_>(std::move(lhs), std::move(rhs));
+    }
+
+    template <typename Message>
+    message_ptr<Message> bit_or(
+        message_ptr<Message>&& lhs, message_ptr<Message>&& rhs)
+    {
+        return reduce_with_<bit_or_op_>(std::move(lhs), std::move(rhs));
+    }
+
+    // these expect payloads of cmk::indexed values
+    template <typename Message>
+    message_ptr<Message> argmin(
+        message_ptr<Message>&& lhs, message_ptr<Message>&& rhs)
+    {
+        return reduce_with_<argmin_op_>(std::move(lhs), std::move(rhs));
+    }
+
+    template <typename Message>
+    message_ptr<Message> argmax(
+        message_ptr<Message>&& lhs, message_ptr<Message>&& rhs)
+    {
+        return reduce_with_<argmax_op_>(std::move(lhs), std::move(rhs));
+    }
+}    // namespace cmk
+
+#endif
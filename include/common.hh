@@ -13,6 +13,8 @@
 #include <unordered_map>
 #include <vector>
 
+#include "flat_map.hh"
+
 namespace cmk {
 
     struct message;
@@ -120,50 +122,100 @@ namespace cmk {
  * - id/index refers to a specific instance
  */
 
+    // define as zero to use the original (wide) message header, whose ids
+    // are word-sized and which always has room for a continuation
+#ifndef CHARMLITE_COMPACT_HEADER
+#define CHARMLITE_COMPACT_HEADER 1
+#endif
+
+    // the type of ids indexing into (registration) tables
+    template <typename Table>
+    using table_id_t_ = typename std::conditional<CHARMLITE_COMPACT_HEADER,
+        std::uint16_t, typename Table::size_type>::type;
+
     // TODO ( rename to callback_fn_t )
     template <typename Message>
     using callback_fn_t = void (*)(message_ptr<Message>&&);
     using callback_table_t = std::vector<callback_fn_t<message>>;
-    using callback_id_t = typename callback_table_t::size_type;
+    using callback_id_t = table_id_t_<callback_table_t>;
 
     // TODO ( rename to combiner_fn_t )
     template <typename Message>
     using combiner_fn_t = message_ptr<Message> (*)(
         message_ptr<Message>&&, message_ptr<Message>&&);
     using combiner_table_t = std::vector<combiner_fn_t<message>>;
-    using combiner_id_t = typename combiner_table_t::size_type;
+    using combiner_id_t = table_id_t_<combiner_table_t>;
 
     using entry_table_t = std::vector<entry_record_>;
-    using entry_id_t = typename entry_table_t::size_type;
+    using entry_id_t = table_id_t_<entry_table_t>;
 
     using chare_table_t = std::vector<chare_record_>;
     using chare_kind_t = typename chare_table_t::size_type;
 
     using collection_kinds_t = std::vector<collection_constructor_t>;
-    using collection_kind_t = typename collection_kinds_t::size_type;
+    using collection_kind_t = table_id_t_<collection_kinds_t>;
 
     using chare_index_t =
         typename std::conditional<std::is_integral<CmiUInt16>::value, CmiUInt16,
             CmiUInt8>::type;
 
+    struct chare_index_hasher_
+    {
+        std::size_t operator()(const chare_index_t& idx) const
+        {
+            // fold the upper half of (wide) indices into the lower
+            return (std::size_t)(idx ^ ((idx >> 32) >> 32));
+        }
+    };
+
     template <typename T>
     using collection_map =
         std::unordered_map<collection_index_t, T, collection_index_hasher_>;
 
+    // the runtime's own tables are flat since they're probed per-message
+    template <typename T>
+    using collection_flat_map_ =
+        flat_map<collection_index_t, T, collection_index_hasher_>;
+
+    template <typename T>
+    using chare_flat_map_ = flat_map<chare_index_t, T, chare_index_hasher_>;
+
     using collection_table_t =
-        collection_map<std::unique_ptr<collection_base_>>;
+        collection_flat_map_<std::unique_ptr<collection_base_>>;
 
     using message_buffer_t = std::deque<message_ptr<message>>;
-    using collection_buffer_t = std::unordered_map<collection_index_t,
-        message_buffer_t, collection_index_hasher_>;
+    using collection_buffer_t = collection_flat_map_<message_buffer_t>;
+
+    // maximum nesting of inline deliveries before falling back to the queue
+#ifndef CHARMLITE_MAX_INLINE_DEPTH
+#define CHARMLITE_MAX_INLINE_DEPTH 16
+#endif
 
     constexpr entry_id_t nil_entry_ = 0;
+    // (used by barriers, i.e., reductions without values)
+    constexpr combiner_id_t nil_combiner_ = 0;
     constexpr collection_kind_t nil_kind_ = 0;
     // TODO ( make these more distinct? )
     constexpr int all = -1;
     constexpr auto chare_bcast_root_ =
         std::numeric_limits<chare_index_t>::max();
 
+    // indices with a "10" prefix address the "leader" of a pe's elements
+    // ( sign-extended negative indices have a "11" prefix )
+    constexpr auto pe_root_bit_ = (chare_index_t) 1
+        << (8 * sizeof(chare_index_t) - 1);
+    constexpr auto pe_root_mask_ = pe_root_bit_ | (pe_root_bit_ >> 1);
+
+    inline chare_index_t pe_root_index_(int pe)
+    {
+        return pe_root_bit_ | (chare_index_t)(std::uint32_t) pe;
+    }
+
+    inline bool is_pe_root_(const chare_index_t& idx)
+    {
+        return (idx & pe_root_mask_) == pe_root_bit_;
+    }
+
     // TODO ( rename this "collective" id type )
     using bcast_id_t = std::uint16_t;
 
@@ -178,6 +230,7 @@ namespace cmk {
     CpvExtern(collection_buffer_t, collection_buffer_);
     CpvExtern(std::uint32_t, local_collection_count_);
     CpvExtern(int, converse_handler_);
+    CpvExtern(std::size_t, inline_depth_);
 
     void initialize_globals_(void);
 
@@ -13,10 +13,11 @@ namespace cmk {
             int pe;
         };
 
+        // (the widest field leads, so wide indices don't leave a hole)
         struct s_endpoint_
         {
-            collection_index_t collection;
             chare_index_t chare;
+            collection_index_t collection;
             entry_id_t entry;
             // reserved for collection communication
             // TODO ( so rename it as such! )
@@ -51,8 +52,8 @@ namespace cmk {
             const chare_index_t& chare, entry_id_t entry)
           : kind_(kEndpoint)
         {
-            new (&(this->impl_.endpoint_)) s_endpoint_{.collection = collection,
-                .chare = chare,
+            new (&(this->impl_.endpoint_)) s_endpoint_{.chare = chare,
+                .collection = collection,
                 .entry = entry,
                 .bcast = 0};
         }
@@ -124,8 +125,16 @@ namespace cmk {
         // when it only needs the collection id!
         inline void* offset_(void)
         {
+            static_assert(sizeof(combiner_id_t) <= sizeof(entry_id_t),
+                "combiner ids must fit in the entry's place");
             return &(this->impl_.endpoint_.entry);
         }
+
+        // and pe-level reductions number themselves with this
+        inline bcast_id_t* sequence_(void)
+        {
+            return &(this->impl_.endpoint_.bcast);
+        }
     };
 }    // namespace cmk
 
@@ -22,6 +22,13 @@ namespace cmk {
         static entry_id_t id_;
     };
 
+    // specialize this to invoke an entry method directly (i.e., without
+    // going through the scheduler) when sending to a local element
+    template <typename T, T t>
+    struct inline_entry : public std::false_type
+    {
+    };
+
     template <typename T, T t, typename Enable = void>
     struct entry_fn_impl_;
 
@@ -31,6 +38,11 @@ namespace cmk {
     {
         static void call_(void* self, message_ptr<>&& msg)
         {
+            // entry methods taking non-const messages get their own copy
+            if (!std::is_const<Message>::value)
+            {
+                make_exclusive_(msg);
+            }
             auto* typed = static_cast<Message*>(msg.release());
             message_ptr<Message> owned(typed);
             (static_cast<T*>(self)->*Fn)(std::move(owned));
@@ -60,6 +72,7 @@ namespace cmk {
         typename std::enable_if<is_message_<Message>()>::type operator()(
             void* self, message_ptr<>&& msg)
         {
+            make_exclusive_(msg);
             auto* typed = static_cast<Message*>(msg.release());
             message_ptr<Message> owned(typed);
             new (static_cast<A*>(self)) A(std::move(owned));
@@ -0,0 +1,551 @@
+#ifndef __CMK_FLAT_MAP_HH__
+#define __CMK_FLAT_MAP_HH__
+
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <iterator>
+#include <new>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace cmk {
+    namespace flat_map_detail_ {
+        using ctrl_t = std::int8_t;
+
+        // control bytes: full slots hold the low 7 bits of their hash
+        constexpr ctrl_t empty_ = -128;
+        constexpr ctrl_t deleted_ = -2;
+
+        constexpr std::size_t group_width_ = 16;
+
+        // a bitmask with one bit set per matching slot in a group
+        struct bitmask_
+        {
+            std::uint32_t bits;
+
+            explicit operator bool(void) const
+            {
+                return this->bits != 0;
+            }
+
+            std::size_t lowest(void) const
+            {
+                return (std::size_t) __builtin_ctz(this->bits);
+            }
+
+            void clear_lowest(void)
+            {
+                this->bits &= (this->bits - 1);
+            }
+        };
+
+        // a view over the control bytes of a group of slots, probed
+        // sixteen at a time (with SSE2 when available)
+        struct group_
+        {
+#if defined(__SSE2__)
+            __m128i ctrl;
+
+            explicit group_(const ctrl_t* pos)
+              : ctrl(_mm_loadu_si128(reinterpret_cast<const __m128i*>(pos)))
+            {
+            }
+
+            bitmask_ match(ctrl_t h2) const
+            {
+                auto cmp = _mm_cmpeq_epi8(_mm_set1_epi8(h2), this->ctrl);
+                return bitmask_{(std::uint32_t) _mm_movemask_epi8(cmp)};
+            }
+
+            bitmask_ match_empty(void) const
+            {
+                return this->match(empty_);
+            }
+
+            // empty and deleted are the only negative control bytes
+            bitmask_ match_empty_or_deleted(void) const
+            {
+                return bitmask_{(std::uint32_t) _mm_movemask_epi8(this->ctrl)};
+            }
+#else
+            const ctrl_t* ctrl;
+
+            explicit group_(const ctrl_t* pos)
+              : ctrl(pos)
+            {
+            }
+
+            bitmask_ match(ctrl_t h2) const
+            {
+                std::uint32_t bits = 0;
+                for (std::size_t i = 0; i < group_width_; i++)
+                {
+                    bits |= (std::uint32_t)(this->ctrl[i] == h2) << i;
+                }
+                return bitmask_{bits};
+            }
+
+            bitmask_ match_empty(void) const
+            {
+                return this->match(empty_);
+            }
+
+            bitmask_ match_empty_or_deleted(void) const
+            {
+                std::uint32_t bits = 0;
+                for (std::size_t i = 0; i < group_width_; i++)
+                {
+                    bits |= (std::uint32_t)(this->ctrl[i] < 0) << i;
+                }
+                return bitmask_{bits};
+            }
+#endif
+        };
+
+        // finalizer from murmur3, since std::hash is often the identity
+        inline std::uint64_t mix(std::uint64_t h)
+        {
+            h ^= h >> 33;
+            h *= 0xff51afd7ed558ccdULL;
+            h ^= h >> 33;
+            h *= 0xc4ceb9fe1a85ec53ULL;
+            h ^= h >> 33;
+            return h;
+        }
+    }    // namespace flat_map_detail_
+
+    // an open-addressing hash map that stores its entries inline, probing
+    // groups of control bytes (a la swiss tables). unlike std::unordered_map
+    // insertions invalidate iterators and references to entries.
+    template <typename Key, typename T, typename Hash = std::hash<Key>,
+        typename KeyEqual = std::equal_to<Key>>
+    class flat_map
+    {
+    public:
+        using key_type = Key;
+        using mapped_type = T;
+        using value_type = std::pair<Key, T>;
+        using size_type = std::size_t;
+
+    private:
+        using ctrl_t = flat_map_detail_::ctrl_t;
+        using group_ = flat_map_detail_::group_;
+        static constexpr auto group_width_ = flat_map_detail_::group_width_;
+
+        ctrl_t* ctrl_;
+        value_type* slots_;
+        size_type capacity_;
+        size_type size_;
+        size_type tombstones_;
+        Hash hash_;
+        KeyEqual eq_;
+
+        template <typename Value>
+        class iterator_base_
+        {
+            friend class flat_map;
+
+            const ctrl_t* ctrl_;
+            Value* slot_;
+            const ctrl_t* end_;
+
+            iterator_base_(const ctrl_t* ctrl, Value* slot, const ctrl_t* end)
+              : ctrl_(ctrl)
+              , slot_(slot)
+              , end_(end)
+            {
+            }
+
+            void skip_(void)
+            {
+                while ((this->ctrl_ != this->end_) && (*(this->ctrl_) < 0))
+                {
+                    this->ctrl_++;
+                    this->slot_++;
+                }
+            }
+
+        public:
+            using iterator_category = std::forward_iterator_tag;
+            using value_type = typename std::remove_const<Value>::type;
+            using difference_type = std::ptrdiff_t;
+            using pointer = Value*;
+            using reference = Value&;
+
+            iterator_base_(void)
+              : iterator_base_(nullptr, nullptr, nullptr)
+            {
+            }
+
+            template <typename Other,
+                typename = typename std::enable_if<
+                    std::is_convertible<Other*, Value*>::value>::type>
+            iterator_base_(const iterator_base_<Other>& other)
+              : iterator_base_(other.ctrl_, other.slot_, other.end_)
+            {
+            }
+
+            reference operator*(void) const
+            {
+                return *(this->slot_);
+            }
+
+            pointer operator->(void) const
+            {
+                return this->slot_;
+            }
+
+            iterator_base_& operator++(void)
+            {
+                this->ctrl_++;
+                this->slot_++;
+                this->skip_();
+                return *this;
+            }
+
+            iterator_base_ operator++(int)
+            {
+                auto prev = *this;
+                ++(*this);
+                return prev;
+            }
+
+            bool operator==(const iterator_base_& other) const
+            {
+                return this->ctrl_ == other.ctrl_;
+            }
+
+            bool operator!=(const iterator_base_& other) const
+            {
+                return this->ctrl_ != other.ctrl_;
+            }
+
+            template <typename Other>
+            friend class iterator_base_;
+        };
+
+    public:
+        using iterator = iterator_base_<value_type>;
+        using const_iterator = iterator_base_<const value_type>;
+
+        flat_map(void)
+          : ctrl_(nullptr)
+          , slots_(nullptr)
+          , capacity_(0)
+          , size_(0)
+          , tombstones_(0)
+        {
+        }
+
+        flat_map(const flat_map&) = delete;
+        flat_map& operator=(const flat_map&) = delete;
+
+        flat_map(flat_map&& other)
+          : flat_map()
+        {
+            this->swap(other);
+        }
+
+        flat_map& operator=(flat_map&& other)
+        {
+            if (this != &other)
+            {
+                this->destroy_();
+                this->swap(other);
+            }
+            return *this;
+        }
+
+        ~flat_map()
+        {
+            this->destroy_();
+        }
+
+        void swap(flat_map& other)
+        {
+            std::swap(this->ctrl_, other.ctrl_);
+            std::swap(this->slots_, other.slots_);
+            std::swap(this->capacity_, other.capacity_);
+            std::swap(this->size_, other.size_);
+            std::swap(this->tombstones_, other.tombstones_);
+            std::swap(this->hash_, other.hash_);
+            std::swap(this->eq_, other.eq_);
+        }
+
+        size_type size(void) const
+        {
+            return this->size_;
+        }
+
+        bool empty(void) const
+        {
+            return this->size_ == 0;
+        }
+
+        size_type capacity(void) const
+        {
+            return this->capacity_;
+        }
+
+        iterator begin(void)
+        {
+            auto it = this->iterator_at_(0);
+            it.skip_();
+            return it;
+        }
+
+        iterator end(void)
+        {
+            return this->iterator_at_(this->capacity_);
+        }
+
+        const_iterator begin(void) const
+        {
+            return const_cast<flat_map*>(this)->begin();
+        }
+
+        const_iterator end(void) const
+        {
+            return const_cast<flat_map*>(this)->end();
+        }
+
+        iterator find(const Key& key)
+        {
+            return this->iterator_at_(this->find_(key));
+        }
+
+        const_iterator find(const Key& key) const
+        {
+            return const_cast<flat_map*>(this)->find(key);
+        }
+
+        size_type count(const Key& key) const
+        {
+            return (this->find_(key) == this->capacity_) ? 0 : 1;
+        }
+
+        // constructs the value in-place from args iff key is absent
+        template <typename K, typename... Args>
+        std::pair<iterator, bool> emplace(K&& key, Args&&... args)
+        {
+            auto pos = this->find_(key);
+            if (pos != this->capacity_)
+            {
+                return std::make_pair(this->iterator_at_(pos), false);
+            }
+            pos = this->prepare_insert_(key);
+            new (this->slots_ + pos) value_type(std::piecewise_construct,
+                std::forward_as_tuple(std::forward<K>(key)),
+                std::forward_as_tuple(std::forward<Args>(args)...));
+            return std::make_pair(this->iterator_at_(pos), true);
+        }
+
+        T& operator[](const Key& key)
+        {
+            return (this->emplace(key).first)->second;
+        }
+
+        iterator erase(iterator it)
+        {
+            auto pos = (std::size_t)(it.ctrl_ - this->ctrl_);
+            this->erase_at_(pos);
+            ++it;
+            return it;
+        }
+
+        size_type erase(const Key& key)
+        {
+            auto pos = this->find_(key);
+            if (pos == this->capacity_)
+            {
+                return 0;
+            }
+            else
+            {
+                this->erase_at_(pos);
+                return 1;
+            }
+        }
+
+        void clear(void)
+        {
+            for (size_type i = 0; i < this->capacity_; i++)
+            {
+                if (this->ctrl_[i] >= 0)
+                {
+                    (this->slots_ + i)->~value_type();
+                }
+            }
+            if (this->ctrl_)
+            {
+                std::memset(this->ctrl_, flat_map_detail_::empty_,
+                    this->capacity_);
+            }
+            this->size_ = this->tombstones_ = 0;
+        }
+
+        // ensures n entries can be stored without a rehash
+        void reserve(size_type n)
+        {
+            auto cap = group_width_;
+            while (max_load_(cap) < n)
+            {
+                cap *= 2;
+            }
+            if (cap > this->capacity_)
+            {
+                this->rehash_(cap);
+            }
+        }
+
+    private:
+        // max. 7/8ths full (including tombstones)
+        static size_type max_load_(size_type capacity)
+        {
+            return capacity - (capacity / 8);
+        }
+
+        iterator iterator_at_(size_type pos)
+        {
+            return iterator(this->ctrl_ + pos, this->slots_ + pos,
+                this->ctrl_ + this->capacity_);
+        }
+
+        std::uint64_t hash_of_(const Key& key) const
+        {
+            return flat_map_detail_::mix(
+                (std::uint64_t)(this->hash_(key)));
+        }
+
+        static ctrl_t h2_(std::uint64_t hash)
+        {
+            return (ctrl_t)(hash & 0x7f);
+        }
+
+        // returns the slot holding key, or capacity when it is absent
+        size_type find_(const Key& key) const
+        {
+            if (this->size_ == 0)
+            {
+                return this->capacity_;
+            }
+            auto hash = this->hash_of_(key);
+            auto h2 = h2_(hash);
+            auto mask = (this->capacity_ / group_width_) - 1;
+            auto g = (std::size_t)(hash >> 7) & mask;
+            for (size_type i = 1;; i++)
+            {
+                auto base = g * group_width_;
+                group_ grp(this->ctrl_ + base);
+                for (auto m = grp.match(h2); m; m.clear_lowest())
+                {
+                    auto pos = base + m.lowest();
+                    if (this->eq_(this->slots_[pos].first, key))
+                    {
+                        return pos;
+                    }
+                }
+                if (grp.match_empty())
+                {
+                    return this->capacity_;
+                }
+                // triangular probing visits every group exactly once
+                g = (g + i) & mask;
+            }
+        }
+
+        // first empty or deleted slot along key's probe sequence
+        size_type find_free_(std::uint64_t hash) const
+        {
+            auto mask = (this->capacity_ / group_width_) - 1;
+            auto g = (std::size_t)(hash >> 7) & mask;
+            for (size_type i = 1;; i++)
+            {
+                auto base = g * group_width_;
+                auto m = group_(this->ctrl_ + base).match_empty_or_deleted();
+                if (m)
+                {
+                    return base + m.lowest();
+                }
+                g = (g + i) & mask;
+            }
+        }
+
+        size_type prepare_insert_(const Key& key)
+        {
+            if ((this->size_ + this->tombstones_ + 1) >
+                max_load_(this->capacity_))
+            {
+                // reclaim tombstones in-place when they are the culprit
+                auto cap = this->capacity_ ? this->capacity_ : group_width_;
+                if (max_load_(cap) <= (2 * (this->size_ + 1)))
+                {
+                    cap *= 2;
+                }
+                this->rehash_(cap);
+            }
+            auto hash = this->hash_of_(key);
+            auto pos = this->find_free_(hash);
+            if (this->ctrl_[pos] == flat_map_detail_::deleted_)
+            {
+                this->tombstones_--;
+            }
+            this->ctrl_[pos] = h2_(hash);
+            this->size_++;
+            return pos;
+        }
+
+        void erase_at_(size_type pos)
+        {
+            (this->slots_ + pos)->~value_type();
+            this->ctrl_[pos] = flat_map_detail_::deleted_;
+            this->size_--;
+            this->tombstones_++;
+        }
+
+        void rehash_(size_type capacity)
+        {
+            auto* old_ctrl = this->ctrl_;
+            auto* old_slots = this->slots_;
+            auto old_capacity = this->capacity_;
+            this->ctrl_ = new ctrl_t[capacity];
+            std::memset(this->ctrl_, flat_map_detail_::empty_, capacity);
+            this->slots_ = static_cast<value_type*>(
+                ::operator new(capacity * sizeof(value_type)));
+            this->capacity_ = capacity;
+            this->tombstones_ = 0;
+            for (size_type i = 0; i < old_capacity; i++)
+            {
+                if (old_ctrl[i] >= 0)
+                {
+                    auto& old = old_slots[i];
+                    auto hash = this->hash_of_(old.first);
+                    auto pos = this->find_free_(hash);
+                    this->ctrl_[pos] = h2_(hash);
+                    new (this->slots_ + pos) value_type(std::move(old));
+                    old.~value_type();
+                }
+            }
+            delete[] old_ctrl;
+            ::operator delete(old_slots);
+        }
+
+        void destroy_(void)
+        {
+            this->clear();
+            delete[] this->ctrl_;
+            ::operator delete(this->slots_);
+            this->ctrl_ = nullptr;
+            this->slots_ = nullptr;
+            this->capacity_ = 0;
+        }
+    };
+}    // namespace cmk
+
+#endif
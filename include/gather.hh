@@ -0,0 +1,222 @@
+#ifndef __CMK_GATHER_HH__
+#define __CMK_GATHER_HH__
+
+#include "message.hh"
+#include "options.hh"
+
+namespace cmk {
+    // an element's values within a gather message
+    struct gather_entry_
+    {
+        chare_index_t index;
+        // (for exchanges between pes) the element the values are from
+        chare_index_t peer;
+        // the position (and number) of its values
+        std::size_t first;
+        std::size_t count;
+    };
+
+    enum gather_phase_ : std::uint8_t
+    {
+        // gather parts move up the tree, scatter parts down it
+        kGatherPhase = 0,
+        kScatterPhase,
+        // and all-to-all parts straight between pes
+        kExchangePhase
+    };
+
+    // the type-erased header of gather messages, which describes their
+    // layout so pes can merge (and split) them without knowing their
+    // value type
+    struct gather_header_
+    {
+        // the room for entries and values (which fixes the layout)
+        std::size_t max_entries;
+        std::size_t max_values;
+        // and how many of each are in use
+        std::size_t n_entries;
+        std::size_t n_values;
+        // the kind of gather message delivered to exchanges' elements
+        message_kind_t kind;
+        // the layout of the array messages holding each entry's values
+        std::size_t elem_size;
+        message_kind_t array_kind;
+        std::size_t array_offset;
+        // for parts moving between pes
+        bcast_id_t seq;
+        entry_id_t entry;
+        gather_phase_ phase;
+    };
+
+    inline std::size_t gather_align_(std::size_t sz)
+    {
+        return ((sz + ALIGN_BYTES - 1) / ALIGN_BYTES) * ALIGN_BYTES;
+    }
+
+    // gather messages store their header right after the common fields,
+    // followed by their entries then their values
+    inline gather_header_* gather_header_for_(message* msg)
+    {
+        return reinterpret_cast<gather_header_*>(
+            reinterpret_cast<char*>(msg) + sizeof(message));
+    }
+
+    inline std::size_t gather_entries_offset_(void)
+    {
+        return gather_align_(sizeof(message) + sizeof(gather_header_));
+    }
+
+    inline std::size_t gather_values_offset_(std::size_t max_entries)
+    {
+        return gather_align_(
+            gather_entries_offset_() + max_entries * sizeof(gather_entry_));
+    }
+
+    inline gather_entry_* gather_entries_(message* msg)
+    {
+        return reinterpret_cast<gather_entry_*>(
+            reinterpret_cast<char*>(msg) + gather_entries_offset_());
+    }
+
+    inline char* gather_values_(message* msg)
+    {
+        auto* hdr = gather_header_for_(msg);
+        return reinterpret_cast<char*>(msg) +
+            gather_values_offset_(hdr->max_entries);
+    }
+
+    // creates an (empty) gather message with the layout of proto and room
+    // for the given number of entries and values
+    inline message_ptr<> make_gather_(message_kind_t kind,
+        const gather_header_& proto, std::size_t max_entries,
+        std::size_t max_values)
+    {
+        auto sz = gather_values_offset_(max_entries) +
+            max_values * proto.elem_size;
+        auto* msg = ::new (allocate_message_(sz)) message(kind, sz);
+        auto* hdr = new (gather_header_for_(msg)) gather_header_(proto);
+        hdr->max_entries = max_entries;
+        hdr->max_values = max_values;
+        hdr->n_entries = hdr->n_values = 0;
+        return message_ptr<>(msg);
+    }
+
+    // appends an entry (copying its values) to a gather message
+    inline void gather_append_(message* msg, const chare_index_t& idx,
+        const void* values, std::size_t count,
+        const chare_index_t& peer = chare_index_t())
+    {
+        auto* hdr = gather_header_for_(msg);
+        CmiAssertMsg((hdr->n_entries < hdr->max_entries) &&
+                ((hdr->n_values + count) <= hdr->max_values),
+            "gather message is full");
+        auto& entry = gather_entries_(msg)[hdr->n_entries++];
+        entry = gather_entry_{idx, peer, hdr->n_values, count};
+        std::memcpy(gather_values_(msg) + hdr->n_values * hdr->elem_size,
+            values, count * hdr->elem_size);
+        hdr->n_values += count;
+    }
+
+    // the parts of gathers, scatters and all-to-alls sent between pes
+    struct gather_part_ : public plain_message<gather_part_>
+    {
+        gather_header_ header_;
+    };
+
+    // holds a variable number of T for each of a collection's elements,
+    // stored contiguously (in order of their entries) after their indices.
+    // this is the result of a gather (in index order), and the input of
+    // a scatter (in any order). for all-to-alls, elements send their
+    // values for each destination and receive those from each source
+    template <typename T>
+    struct gather_message : public plain_message<gather_message<T>>
+    {
+        static_assert(std::is_trivially_copyable<T>::value,
+            "gather messages are sent without packing");
+        static_assert(alignof(T) <= ALIGN_BYTES, "values are overaligned");
+
+        using type = T;
+
+    private:
+        gather_header_ header_;
+
+    public:
+        // creates a message with room for the given number of entries
+        // and values (in total), to be filled in through append
+        static message_ptr<gather_message<T>> make(
+            std::size_t max_entries, std::size_t max_values)
+        {
+            gather_header_ proto{};
+            proto.kind = message_helper_<gather_message<T>>::kind_;
+            proto.elem_size = sizeof(T);
+            proto.array_kind = message_helper_<array_message<T>>::kind_;
+            proto.array_offset = array_message<T>::offset_();
+            auto msg = make_gather_(message_helper_<gather_message<T>>::kind_,
+                proto, max_entries, max_values);
+            return message_ptr<gather_message<T>>(
+                static_cast<gather_message<T>*>(msg.release()));
+        }
+
+        template <typename Index>
+        void append(const Index& idx, const T* values, std::size_t count)
+        {
+            gather_append_(
+                this, index_view<Index>::encode(idx), values, count);
+        }
+
+        // the number of entries
+        std::size_t size(void) const
+        {
+            return this->header_.n_entries;
+        }
+
+        // the total number of values
+        std::size_t n_values(void) const
+        {
+            return this->header_.n_values;
+        }
+
+        template <typename Index>
+        const Index& index(std::size_t i) const
+        {
+            return index_view<Index>::decode(this->entry_(i).index);
+        }
+
+        std::size_t count(std::size_t i) const
+        {
+            return this->entry_(i).count;
+        }
+
+        T* values(std::size_t i)
+        {
+            return this->data() + this->entry_(i).first;
+        }
+
+        const T* values(std::size_t i) const
+        {
+            return this->data() + this->entry_(i).first;
+        }
+
+        // all of the values, in order of their entries
+        T* data(void)
+        {
+            return reinterpret_cast<T*>(gather_values_(this));
+        }
+
+        const T* data(void) const
+        {
+            auto* self = const_cast<gather_message<T>*>(this);
+            return reinterpret_cast<const T*>(gather_values_(self));
+        }
+
+    private:
+        const gather_entry_& entry_(std::size_t i) const
+        {
+            CmiAssert(i < this->header_.n_entries);
+            auto* self = const_cast<gather_message<T>*>(this);
+            return gather_entries_(self)[i];
+        }
+    };
+}    // namespace cmk
+
+#endif
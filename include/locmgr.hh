@@ -4,6 +4,13 @@
 #include <algorithm>
 
 #include "common.hh"
+#include "tree.hh"
+
+// define as zero to send every pe's partials through the tree (rather
+// than combining them within each node first) in smp builds
+#ifndef CHARMLITE_NODE_REDUCTIONS
+#define CHARMLITE_NODE_REDUCTIONS 1
+#endif
 
 namespace cmk {
 
@@ -27,85 +34,357 @@ namespace cmk {
     template <typename Mapper>
     class locmgr;
 
+    // lists every pe (in order)
+    inline std::vector<int> all_pes_(void)
+    {
+        std::vector<int> pes(CmiNumPes());
+        for (auto pe = 0; pe < CmiNumPes(); pe++)
+        {
+            pes[pe] = pe;
+        }
+        return pes;
+    }
+
     template <typename Mapper>
     class locmgr_base_
     {
     protected:
         Mapper mapper_;
+        tree_shape shape_ = tree_shape::kary();
+        // whether the cached tree is valid
+        mutable bool valid_ = false;
+        mutable node_tree_ node_{0, -1};
+        // scans take a binomial tree, since each of its subtrees spans a
+        // contiguous range of pes (so prefixes follow pe order)
+        mutable int scan_parent_ = -1;
+        mutable std::vector<int> scan_children_;
+        // the pes spanned by the tree (in order)
+        mutable std::vector<int> tree_pes_;
 
     public:
+        void set_tree(const tree_shape& shape)
+        {
+            this->shape_ = shape;
+            this->valid_ = false;
+        }
+
+        // whether pes combine their partials in a per-node accumulator,
+        // so only one message per node enters the tree between nodes
+        bool combines_on_node(void) const
+        {
+            return CHARMLITE_NODE_REDUCTIONS && (CmiMyNodeSize() > 1);
+        }
+
         int pe_for(const chare_index_t& idx) const
         {
-            return this->mapper_.pe_for(idx);
+            if (is_pe_root_(idx))
+            {
+                return (int) (std::uint32_t) idx;
+            }
+            else
+            {
+                return this->mapper_.pe_for(idx);
+            }
+        }
+
+        // records that pe hosts one of the collection's initial elements
+        void add_member(int pe) {}
+
+        // records the creation of a local element
+        void on_insert(const chare_index_t& idx) {}
+
+        // replaces a local pe's root index with that of its leader,
+        // returning false if the pe does not (yet) have any elements
+        bool resolve(chare_index_t& idx) const
+        {
+            return true;
         }
     };
 
+    // collectives on collections proceed over a tree of pes where each
+    // pe's first element (i.e., its leader) relays them to the pe's other
+    // elements. pes are addressed by their root index, which is resolved
+    // to its leader upon arrival, so pes need not know each others' leaders
+    // NOTE ( membership is only known for collections seeded with a range,
+    //        otherwise every pe participates and collectives stall on pes
+    //        until they host an element. )
     template <typename Mapper>
     class locmgr : public locmgr_base_<Mapper>
     {
+        // pes hosting seeded elements (in order), empty when all pes do
+        std::vector<bool> members_;
+        std::vector<int> pes_;
+        // local elements in order of creation
+        std::vector<chare_index_t> locals_;
+        // this pe's part of the tree, cached until membership changes
+        mutable std::vector<chare_index_t> children_;
+        mutable std::vector<chare_index_t> parent_;
+        mutable std::vector<chare_index_t> leader_;
+
     public:
-        // NOTE ( these methods will have to be expanded if/when
-        //        we add support for sections. )
+        void add_member(int pe)
+        {
+            if (this->members_.empty())
+            {
+                this->members_.resize(CmiNumPes(), false);
+            }
+            if (!this->members_[pe])
+            {
+                this->members_[pe] = true;
+                auto pos = std::lower_bound(
+                    std::begin(this->pes_), std::end(this->pes_), pe);
+                this->pes_.insert(pos, pe);
+                this->valid_ = false;
+            }
+        }
+
+        void on_insert(const chare_index_t& idx)
+        {
+            this->locals_.emplace_back(idx);
+            this->valid_ = false;
+        }
+
+        bool resolve(chare_index_t& idx) const
+        {
+            if (is_pe_root_(idx))
+            {
+                CmiAssert(this->pe_for(idx) == CmiMyPe());
+                if (this->locals_.empty())
+                {
+                    return false;
+                }
+                else
+                {
+                    idx = this->locals_.front();
+                }
+            }
+            return true;
+        }
+
         chare_index_t root(void) const
         {
-            CmiAbort("not implemented.");
+            return pe_root_index_(this->pes_.empty() ? 0 : this->pes_.front());
+        }
+
+        const std::vector<chare_index_t>& upstream(
+            const chare_index_t& idx) const
+        {
+            this->validate_();
+            return this->is_leader_(idx) ? this->children_ : none_();
+        }
+
+        const std::vector<chare_index_t>& downstream(
+            const chare_index_t& idx) const
+        {
+            this->validate_();
+            return this->is_leader_(idx) ? this->parent_ : this->leader_;
+        }
+
+        // the number of local elements that send partials to idx
+        std::size_t local_upstream(const chare_index_t& idx) const
+        {
+            return this->is_leader_(idx) ? (this->locals_.size() - 1) : 0;
+        }
+
+        // whether idx combines the partials of this pe's elements
+        bool is_leader(const chare_index_t& idx) const
+        {
+            return this->is_leader_(idx);
+        }
+
+        const node_tree_& node_tree(void) const
+        {
+            this->validate_();
+            return this->node_;
+        }
+
+        chare_index_t address_of(int pe) const
+        {
+            return pe_root_index_(pe);
+        }
+
+        // the number of elements on this pe
+        std::size_t n_locals(void) const
+        {
+            return this->locals_.size();
+        }
+
+        int scan_parent(void) const
+        {
+            this->validate_();
+            return this->scan_parent_;
+        }
+
+        const std::vector<int>& scan_children(void) const
+        {
+            this->validate_();
+            return this->scan_children_;
+        }
+
+        const std::vector<int>& pes(void) const
+        {
+            this->validate_();
+            return this->tree_pes_;
         }
 
-        std::vector<chare_index_t> upstream(const chare_index_t& idx) const
+    private:
+        static const std::vector<chare_index_t>& none_(void)
         {
-            CmiAbort("not implemented.");
+            static const std::vector<chare_index_t> none;
+            return none;
+        }
+
+        // (re)builds this pe's part of the tree, reusing storage
+        void validate_(void) const
+        {
+            if (this->valid_)
+            {
+                return;
+            }
+            this->children_.clear();
+            this->parent_.clear();
+            this->leader_.clear();
+            if (!this->locals_.empty())
+            {
+                // the leader relays to the other local elements
+                this->children_.assign(
+                    std::begin(this->locals_) + 1, std::end(this->locals_));
+                this->leader_.emplace_back(this->locals_.front());
+            }
+            // and to the leaders of its child pes
+            int parent;
+            std::vector<int> children;
+            this->tree_pes_ = this->pes_.empty() ? all_pes_() : this->pes_;
+            const auto& pes = this->tree_pes_;
+            build_tree_(this->shape_, pes, CmiMyPe(), parent, children);
+            if (this->combines_on_node())
+            {
+                this->node_ = build_node_tree_(this->shape_, pes, CmiMyPe());
+            }
+            this->scan_children_.clear();
+            build_tree_(tree_shape::binomial(), pes, CmiMyPe(),
+                this->scan_parent_, this->scan_children_);
+            for (auto& child : children)
+            {
+                this->children_.emplace_back(pe_root_index_(child));
+            }
+            if (parent >= 0)
+            {
+                this->parent_.emplace_back(pe_root_index_(parent));
+            }
+            this->valid_ = true;
         }
 
-        std::vector<chare_index_t> downstream(const chare_index_t& idx) const
+        bool is_leader_(const chare_index_t& idx) const
         {
-            CmiAbort("not implemented.");
+            return !(this->locals_.empty()) && (this->locals_.front() == idx);
         }
     };
 
     template <>
     class locmgr<group_mapper<int>> : public locmgr_base_<group_mapper<int>>
     {
+        // this pe's part of the tree (computed on first use)
+        mutable std::vector<chare_index_t> children_;
+        mutable std::vector<chare_index_t> parent_;
+
     public:
         chare_index_t root(void) const
         {
-            CmiAssert(CmiSpanTreeParent(0) < 0);
             return index_view<int>::encode(0);
         }
 
-        std::vector<chare_index_t> upstream(const chare_index_t& idx) const
+        const std::vector<chare_index_t>& upstream(
+            const chare_index_t& idx) const
+        {
+            CmiAssert(this->pe_for(idx) == CmiMyPe());
+            this->validate_();
+            return this->children_;
+        }
+
+        const std::vector<chare_index_t>& downstream(
+            const chare_index_t& idx) const
+        {
+            CmiAssert(this->pe_for(idx) == CmiMyPe());
+            this->validate_();
+            return this->parent_;
+        }
+
+        // each pe has exactly one element
+        std::size_t local_upstream(const chare_index_t&) const
+        {
+            return 0;
+        }
+
+        bool is_leader(const chare_index_t&) const
+        {
+            return true;
+        }
+
+        const node_tree_& node_tree(void) const
+        {
+            this->validate_();
+            return this->node_;
+        }
+
+        chare_index_t address_of(int pe) const
+        {
+            return index_view<int>::encode(pe);
+        }
+
+        std::size_t n_locals(void) const
+        {
+            return 1;
+        }
+
+        int scan_parent(void) const
+        {
+            this->validate_();
+            return this->scan_parent_;
+        }
+
+        const std::vector<int>& scan_children(void) const
+        {
+            this->validate_();
+            return this->scan_children_;
+        }
+
+        const std::vector<int>& pes(void) const
+        {
+            this->validate_();
+            return this->tree_pes_;
+        }
+
+    private:
+        void validate_(void) const
         {
-            auto pe = this->pe_for(idx);
-            auto n_children = CmiNumSpanTreeChildren(pe);
-            if (n_children > 0)
+            if (this->valid_)
             {
-                // copied from qd.h -- memcheck seems to be legacy?
-                std::vector<int> child_pes(n_children);
-                _MEMCHECK(child_pes.data());
-                CmiSpanTreeChildren(CmiMyPe(), child_pes.data());
-                std::vector<chare_index_t> children;
-                children.reserve(n_children);
-                std::transform(std::begin(child_pes), std::end(child_pes),
-                    std::back_inserter(children), index_view<int>::encode);
-                return children;
+                return;
             }
-            else
+            int parent;
+            std::vector<int> children;
+            this->tree_pes_ = all_pes_();
+            const auto& pes = this->tree_pes_;
+            build_tree_(this->shape_, pes, CmiMyPe(), parent, children);
+            if (this->combines_on_node())
             {
-                return {};
+                this->node_ = build_node_tree_(this->shape_, pes, CmiMyPe());
             }
-        }
-
-        std::vector<chare_index_t> downstream(const chare_index_t& idx) const
-        {
-            auto pe = this->pe_for(idx);
-            auto parent = CmiSpanTreeParent(pe);
-            if (parent >= 0)
+            this->scan_children_.clear();
+            build_tree_(tree_shape::binomial(), pes, CmiMyPe(),
+                this->scan_parent_, this->scan_children_);
+            this->children_.clear();
+            this->parent_.clear();
+            for (auto& child : children)
             {
-                return {index_view<int>::encode(parent)};
+                this->children_.emplace_back(index_view<int>::encode(child));
             }
-            else
+            if (parent >= 0)
             {
-                return {};
+                this->parent_.emplace_back(index_view<int>::encode(parent));
             }
+            this->valid_ = true;
         }
     };
 }    // namespace cmk
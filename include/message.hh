@@ -1,10 +1,13 @@
 #ifndef __CMK_MSG_HH__
 #define __CMK_MSG_HH__
 
+#include <algorithm>
 #include <array>
 #include <bitset>
+#include <cstring>
 
 #include "common.hh"
+#include "pool.hh"
 
 namespace cmk {
     using message_deleter_t = void (*)(void*);
@@ -16,18 +19,25 @@ namespace cmk {
         message_deleter_t deleter_;
         message_packer_t packer_;
         message_unpacker_t unpacker_;
+        // whether pes can safely share a (read-only) instance
+        bool shareable_;
+        // whether this is a kind of array_message (so it can be segmented)
+        bool array_;
 
         message_record_(const message_deleter_t& deleter,
-            const message_packer_t& packer, const message_unpacker_t& unpacker)
+            const message_packer_t& packer, const message_unpacker_t& unpacker,
+            bool trivially_destructible, bool array)
           : deleter_(deleter)
           , packer_(packer)
           , unpacker_(unpacker)
+          , shareable_(trivially_destructible && (packer == nullptr))
+          , array_(array)
         {
         }
     };
 
     using message_table_t = std::vector<message_record_>;
-    using message_kind_t = typename message_table_t::size_type;
+    using message_kind_t = table_id_t_<message_table_t>;
     CsvExtern(message_table_t, message_table_);
 
     template <typename T>
@@ -36,12 +46,146 @@ namespace cmk {
         static message_kind_t kind_;
     };
 
+    // the room for bit-vector priorities (whose bits past it are ignored)
+#ifndef CHARMLITE_PRIORITY_WORDS
+#define CHARMLITE_PRIORITY_WORDS 2
+#endif
+
+    // a message's priority, honored by converse's prioritized queue:
+    // either an integer, or a bit-vector compared lexicographically (and
+    // in both cases, lower values are handled first)
+    struct priority
+    {
+        using words_type = std::array<unsigned int, CHARMLITE_PRIORITY_WORDS>;
+
+        // how converse queues the message (in order, by default)
+        std::uint8_t queueing = CQS_QUEUEING_FIFO;
+        std::uint16_t nbits = 0;
+        words_type words{};
+
+        priority(void) = default;
+
+        priority(int prio)
+          : queueing(CQS_QUEUEING_IFIFO)
+          , nbits(8 * sizeof(int))
+        {
+            std::memcpy(this->words.data(), &prio, sizeof(int));
+        }
+
+        // takes the first nbits of words (most significant bit first)
+        priority(const unsigned int* words_, int nbits_)
+          : queueing(CQS_QUEUEING_BFIFO)
+          , nbits(std::min<int>(nbits_, 8 * sizeof(words_type)))
+        {
+            auto n = (this->nbits + 8 * sizeof(unsigned int) - 1) /
+                (8 * sizeof(unsigned int));
+            std::copy(words_, words_ + n, this->words.begin());
+        }
+
+        explicit operator bool(void) const
+        {
+            return this->queueing != CQS_QUEUEING_FIFO;
+        }
+    };
+
+    // where (and with what priority) an operation's result is sent
+    struct continuation_
+    {
+        destination dst;
+        priority prio;
+    };
+
+    // compact headers store priorities (then continuations) after their
+    // message's contents, each starting at an aligned offset
+    constexpr std::size_t trailer_align_ = alignof(continuation_);
+    constexpr std::size_t priority_trailer_ =
+        ((sizeof(priority) + trailer_align_ - 1) / trailer_align_) *
+        trailer_align_;
+
+#if CHARMLITE_COMPACT_HEADER
+    // the flags packed into a half-word (where std::bitset takes a word)
+    class flag_set_
+    {
+        std::uint16_t bits_;
+
+    public:
+        class reference
+        {
+            std::uint16_t* bits_;
+            std::uint16_t mask_;
+
+        public:
+            reference(std::uint16_t* bits, std::uint16_t mask)
+              : bits_(bits)
+              , mask_(mask)
+            {
+            }
+
+            operator bool(void) const
+            {
+                return (*(this->bits_) & this->mask_) != 0;
+            }
+
+            reference& operator=(bool value)
+            {
+                if (value)
+                {
+                    *(this->bits_) |= this->mask_;
+                }
+                else
+                {
+                    *(this->bits_) &= ~(this->mask_);
+                }
+                return *this;
+            }
+
+            reference& operator=(const reference& other)
+            {
+                return (*this = (bool) other);
+            }
+        };
+
+        flag_set_(unsigned long bits = 0)
+          : bits_((std::uint16_t) bits)
+        {
+        }
+
+        reference operator[](std::size_t pos)
+        {
+            return reference(&(this->bits_), (std::uint16_t)(1 << pos));
+        }
+
+        bool operator[](std::size_t pos) const
+        {
+            return (this->bits_ & (1 << pos)) != 0;
+        }
+
+        unsigned long to_ulong(void) const
+        {
+            return this->bits_;
+        }
+    };
+
+    // the kind, flags and size share a word, and priorities and
+    // continuations trail the message's contents (only taking up room
+    // when they're set)
+#define CMK_MESSAGE_FIELDS                                                     \
+    std::array<char, CmiMsgHeaderSizeBytes> core_;                             \
+    message_kind_t kind_;                                                      \
+    flag_set_ flags_;                                                          \
+    std::uint32_t total_size_;                                                 \
+    destination dst_;
+#else
+    using flag_set_ = std::bitset<16>;
+
 #define CMK_MESSAGE_FIELDS                                                     \
     std::array<char, CmiMsgHeaderSizeBytes> core_;                             \
     message_kind_t kind_;                                                      \
-    std::bitset<8> flags_;                                                     \
+    flag_set_ flags_;                                                          \
+    priority priority_;                                                        \
     std::size_t total_size_;                                                   \
     destination dst_;
+#endif
 
     namespace {
         struct message_fields_
@@ -50,26 +194,44 @@ namespace cmk {
         };
     }    // namespace
 
+#if CHARMLITE_COMPACT_HEADER
+    // pad the messages out to an aligned size (explicitly, otherwise the
+    // compiler may place a derived message's fields in the padding)
+    constexpr auto header_end_ =
+        offsetof(message_fields_, dst_) + sizeof(destination);
+    using header_padding_t =
+        std::array<std::uint8_t, ALIGN_BYTES - (header_end_ % ALIGN_BYTES)>;
+#else
     // pad the messages with extra room for a continuation
     constexpr auto reserve_align =
-        (sizeof(message_fields_) + sizeof(destination)) % ALIGN_BYTES;
+        (sizeof(message_fields_) + sizeof(continuation_)) % ALIGN_BYTES;
     // TODO ( use std::byte if we upgrade )
     using aligned_reserve_t =
-        std::array<std::uint8_t, sizeof(destination) + reserve_align>;
+        std::array<std::uint8_t, sizeof(continuation_) + reserve_align>;
+#endif
 
     struct message
     {
         CMK_MESSAGE_FIELDS;
+#if CHARMLITE_COMPACT_HEADER
+        header_padding_t padding_;
+#else
         aligned_reserve_t reserve_;
+#endif
 
     private:
         static constexpr auto has_combiner_ = 0;
         static constexpr auto has_continuation_ = has_combiner_ + 1;
         static constexpr auto has_collection_kind_ = has_continuation_ + 1;
         static constexpr auto is_packed_ = has_collection_kind_ + 1;
+        static constexpr auto is_inline_ = is_packed_ + 1;
+        static constexpr auto is_node_partial_ = is_inline_ + 1;
+        static constexpr auto is_segment_ = is_node_partial_ + 1;
+        static constexpr auto is_enqueued_ = is_segment_ + 1;
+        static constexpr auto has_priority_ = is_enqueued_ + 1;
 
     public:
-        using flag_type = std::bitset<8>::reference;
+        using flag_type = flag_set_::reference;
 
         message(void)
           : kind_(0)
@@ -82,6 +244,7 @@ namespace cmk {
           : kind_(kind)
           , total_size_(total_size)
         {
+            CmiAssertMsg(total_size <= max_size(), "message is too large");
             // FIXME ( DRY failure )
             CmiSetHandler(this, CpvAccess(converse_handler_));
         }
@@ -98,11 +261,45 @@ namespace cmk {
             }
         }
 
-        destination* continuation(void)
+        // the sequence number of a pe-level reduction
+        bcast_id_t& sequence(void)
+        {
+            CmiAssert(this->has_combiner() && (this->dst_.kind() == kCallback));
+            return *(this->dst_.sequence_());
+        }
+
+        continuation_* continuation(void)
         {
             if (this->has_continuation())
             {
-                return reinterpret_cast<destination*>(this->reserve_.data());
+#if CHARMLITE_COMPACT_HEADER
+                auto* end = reinterpret_cast<char*>(this) + this->total_size_;
+                return reinterpret_cast<continuation_*>(
+                    end - sizeof(continuation_));
+#else
+                return reinterpret_cast<continuation_*>(this->reserve_.data());
+#endif
+            }
+            else
+            {
+                return nullptr;
+            }
+        }
+
+        priority* prio(void)
+        {
+            if (this->has_priority())
+            {
+#if CHARMLITE_COMPACT_HEADER
+                auto* end = reinterpret_cast<char*>(this) + this->total_size_;
+                if (this->has_continuation())
+                {
+                    end -= sizeof(continuation_);
+                }
+                return reinterpret_cast<priority*>(end - priority_trailer_);
+#else
+                return &(this->priority_);
+#endif
             }
             else
             {
@@ -130,6 +327,38 @@ namespace cmk {
             return this->flags_[has_collection_kind_];
         }
 
+        // whether a send should (try to) deliver this message immediately
+        flag_type is_inline(void)
+        {
+            return this->flags_[is_inline_];
+        }
+
+        // whether this is a node's partial result (bound for the
+        // accumulator of its parent node)
+        flag_type is_node_partial(void)
+        {
+            return this->flags_[is_node_partial_];
+        }
+
+        // whether this is a segment of a (larger) array message
+        flag_type is_segment(void)
+        {
+            return this->flags_[is_segment_];
+        }
+
+        // whether this message was (re)queued by its priority on this pe,
+        // so it's ready to be handled
+        flag_type is_enqueued(void)
+        {
+            return this->flags_[is_enqueued_];
+        }
+
+        // whether this message is queued by its priority (see prio)
+        flag_type has_priority(void)
+        {
+            return this->flags_[has_priority_];
+        }
+
         template <typename T>
         static void free(std::unique_ptr<T>& msg)
         {
@@ -182,35 +411,62 @@ namespace cmk {
             }
         }
 
+        // whether this message can be referenced by multiple pes
+        // ( that is, it needs neither packing nor destruction )
+        bool is_shareable(void) const
+        {
+            auto* rec = this->record();
+            return (rec == nullptr) || rec->shareable_;
+        }
+
+        bool is_array(void) const
+        {
+            auto* rec = this->record();
+            return (rec != nullptr) && rec->array_;
+        }
+
+        // whether this message is currently referenced by multiple pes
+        bool is_shared(void) const
+        {
+            return CmiGetReference((void*) this) > 1;
+        }
+
         // clones a PACKED message
         template <typename T = message>
         message_ptr<T> clone(void) const
         {
             CmiAssert(this->is_cloneable());
-            auto* typed = reinterpret_cast<T*>(
-                CmiCopyMsg((char*) this, this->total_size_));
-            return message_ptr<T>(typed);
+            auto* blk = allocate_message_(this->total_size_);
+            std::memcpy(blk, this, this->total_size_);
+            return message_ptr<T>(reinterpret_cast<T*>(blk));
+        }
+
+        // the largest size the header can describe
+        static constexpr std::size_t max_size(void)
+        {
+            return std::numeric_limits<decltype(total_size_)>::max();
         }
 
         void* operator new(std::size_t count, std::size_t sz)
         {
             CmiAssert(sz >= sizeof(message));
-            return CmiAlloc(sz);
+            CmiAssertMsg(sz <= max_size(), "message is too large");
+            return allocate_message_(sz);
         }
 
         void operator delete(void* blk, std::size_t sz)
         {
-            CmiFree(blk);
+            free_message_(blk);
         }
 
         void* operator new(std::size_t sz)
         {
-            return CmiAlloc(sz);
+            return allocate_message_(sz);
         }
 
         void operator delete(void* blk)
         {
-            CmiFree(blk);
+            free_message_(blk);
         }
 
         bool is_broadcast(void)
@@ -225,6 +481,9 @@ namespace cmk {
         auto* fn = rec ? rec->packer_ : nullptr;
         if (fn && !(msg->is_packed()))
         {
+            // ( flagged beforehand so copies of its header, made by the
+            //   packer, are never packed again; see reserve_trailers_ )
+            msg->is_packed() = true;
             fn(msg);
             msg->is_packed() = true;
         }
@@ -241,6 +500,191 @@ namespace cmk {
         }
     }
 
+    // ensures that the caller holds the only reference to a message,
+    // copying it if it's shared (i.e., copy-on-write)
+    inline void make_exclusive_(message_ptr<>& msg)
+    {
+        if (msg && msg->is_shared())
+        {
+            auto copy = msg->clone();
+            msg.reset(copy.release());
+        }
+    }
+
+    // the size of a message (of sz bytes) once n bytes of trailers are
+    // appended to it (which only compact headers need room for)
+    inline std::size_t trailed_size_(std::size_t sz, std::size_t n)
+    {
+#if CHARMLITE_COMPACT_HEADER
+        sz = ((sz + trailer_align_ - 1) / trailer_align_) * trailer_align_ + n;
+        CmiAssertMsg(sz <= message::max_size(), "message is too large");
+#endif
+        return sz;
+    }
+
+    // the size of a message (of sz bytes) once a continuation is appended
+    inline std::size_t continued_size_(std::size_t sz)
+    {
+        return trailed_size_(sz, sizeof(continuation_));
+    }
+
+    // the size of a message with sz bytes of contents and src's trailers
+    inline std::size_t size_with_trailers_(message* src, std::size_t sz)
+    {
+        auto n = (src->has_priority() ? priority_trailer_ : 0) +
+            (src->has_continuation() ? sizeof(continuation_) : 0);
+        return trailed_size_(sz, n);
+    }
+
+    // appends a priority to a message whose block has room for it (before
+    // its continuation is, since those come last)
+    inline void append_priority_(message* msg, const priority& prio)
+    {
+#if CHARMLITE_COMPACT_HEADER
+        if (!msg->has_priority())
+        {
+            CmiAssert(!msg->has_continuation());
+            auto sz = trailed_size_(msg->total_size_, priority_trailer_);
+            CmiAssert((std::size_t) CmiSize(msg) >= sz);
+            msg->total_size_ = sz;
+        }
+#endif
+        msg->has_priority() = true;
+        new (msg->prio()) priority(prio);
+    }
+
+    // appends a continuation to a message whose block has room for it
+    inline void append_continuation_(message* msg, const continuation_& cont)
+    {
+#if CHARMLITE_COMPACT_HEADER
+        if (!msg->has_continuation())
+        {
+            auto sz = continued_size_(msg->total_size_);
+            CmiAssert((std::size_t) CmiSize(msg) >= sz);
+            msg->total_size_ = sz;
+        }
+#endif
+        msg->has_continuation() = true;
+        new (msg->continuation()) continuation_(cont);
+    }
+
+    // copies src's trailers onto dst, whose size excludes them (but whose
+    // block has room for them, see size_with_trailers_)
+    inline void copy_trailers_(message* dst, message* src)
+    {
+        dst->has_priority() = false;
+        dst->has_continuation() = false;
+        if (auto* prio = src->prio())
+        {
+            append_priority_(dst, *prio);
+        }
+        if (auto* cont = src->continuation())
+        {
+            append_continuation_(dst, *cont);
+        }
+    }
+
+    // (the message's contents are left as-is)
+    inline void clear_continuation_(message* msg)
+    {
+#if CHARMLITE_COMPACT_HEADER
+        if (msg->has_continuation())
+        {
+            msg->total_size_ -= sizeof(continuation_);
+        }
+#endif
+        msg->has_continuation() = false;
+    }
+
+    // ensures a message has room for n more bytes of trailers. messages
+    // without it are moved into a larger block (bitwise, so they're packed
+    // for the move if they can be), which invalidates pointers into them
+    inline void reserve_trailers_(message_ptr<>& msg, std::size_t n)
+    {
+#if CHARMLITE_COMPACT_HEADER
+        auto sz = trailed_size_(msg->total_size_, n);
+        if ((std::size_t) CmiSize(msg.get()) < sz)
+        {
+            // ( messages being packed, i.e., this was reached from their
+            //   packer, are already flagged so they aren't packed again )
+            auto repack = !msg->is_packed();
+            pack_message(msg);
+            repack = repack && msg->is_packed();
+            // ( packing can change the message's size )
+            sz = trailed_size_(msg->total_size_, n);
+            if ((std::size_t) CmiSize(msg.get()) < sz)
+            {
+                auto* blk = allocate_message_(sz);
+                std::memcpy(blk, msg.get(), msg->total_size_);
+                // ( the original was moved, so it's not destroyed )
+                free_message_(msg.release());
+                msg.reset(static_cast<message*>(blk));
+            }
+            if (repack)
+            {
+                unpack_message(msg);
+            }
+        }
+#endif
+    }
+
+    // sets a message's continuation, which compact headers store after
+    // the message's contents (see reserve_trailers_)
+    inline void set_continuation_(
+        message_ptr<>& msg, const continuation_& cont)
+    {
+        if (!msg->has_continuation())
+        {
+            reserve_trailers_(msg, sizeof(continuation_));
+        }
+        append_continuation_(msg.get(), cont);
+    }
+
+    // sets a message's priority, which compact headers store (like its
+    // continuation) after the message's contents
+    inline void set_priority_(message_ptr<>& msg, const priority& prio)
+    {
+        if (msg->has_priority())
+        {
+            *(msg->prio()) = prio;
+            return;
+        }
+        else if (!prio)
+        {
+            return;
+        }
+        // ( continuations come last, so the priority goes before it )
+        auto* cont = msg->continuation();
+        continuation_ moved;
+        if (cont)
+        {
+            moved = *cont;
+            clear_continuation_(msg.get());
+        }
+        reserve_trailers_(
+            msg, priority_trailer_ + (cont ? sizeof(continuation_) : 0));
+        append_priority_(msg.get(), prio);
+        if (cont)
+        {
+            append_continuation_(msg.get(), moved);
+        }
+    }
+
+    // sets a message's priority (this can move it, see reserve_trailers_)
+    template <typename Message>
+    inline void set_priority(message_ptr<Message>& msg, const priority& prio)
+    {
+        set_priority_(reinterpret_cast<message_ptr<>&>(msg), prio);
+    }
+
+    // erases the type (and const-ness) of a message
+    template <typename Message>
+    inline message_ptr<> mutable_message_(message_ptr<Message>&& msg)
+    {
+        using type = typename std::remove_const<Message>::type;
+        return message_ptr<>(const_cast<type*>(msg.release()));
+    }
+
     inline void pack_and_free_(char* dst, message_ptr<>&& src)
     {
         pack_message(src);
@@ -249,6 +693,21 @@ namespace cmk {
 
     static_assert(sizeof(message) % ALIGN_BYTES == 0, "message unaligned");
 
+    // the bytes each message spends on its header (before its contents)
+    constexpr std::size_t header_size = sizeof(message);
+
+#if CHARMLITE_COMPACT_HEADER
+    // i.e., converse's header, a word (for the kind, flags and size) and
+    // the destination, padded out to an aligned size
+    static_assert(header_size ==
+            ((CmiMsgHeaderSizeBytes + sizeof(std::uint64_t) +
+                 sizeof(destination)) /
+                    ALIGN_BYTES +
+                1) *
+                ALIGN_BYTES,
+        "compact message header outgrew its layout");
+#endif
+
 #undef CMK_MESSAGE_FIELDS
 
     template <typename T>
@@ -288,9 +747,404 @@ namespace cmk {
         }
     };
 
+    // the type-erased header of array messages, which describes their
+    // layout so large reductions can be split into (and joined from)
+    // segments without knowing their element type
+    struct array_header_
+    {
+        // number of elements in (and their offset from the start of)
+        // this message, and the size of each
+        std::size_t size;
+        std::size_t offset;
+        std::size_t elem_size;
+        // for segments: where they fit into the whole array, and the
+        // reduction they're a part of (i.e., its first sequence number)
+        std::size_t first;
+        std::size_t extent;
+        collection_index_t origin;
+        bcast_id_t base;
+    };
+
+    // array messages store their header right after the common fields
+    inline array_header_* array_header_for_(message* msg)
+    {
+        CmiAssert(msg->is_array());
+        return reinterpret_cast<array_header_*>(
+            reinterpret_cast<char*>(msg) + sizeof(message));
+    }
+
+    template <typename T>
+    struct gather_message;
+
+    // a message carrying a contiguous array of T whose length is chosen at
+    // runtime, with the elements stored (inline) after its header
+    template <typename T>
+    struct array_message : public plain_message<array_message<T>>
+    {
+        static_assert(std::is_trivially_copyable<T>::value,
+            "array messages are sent without packing");
+
+        using type = T;
+
+        friend struct gather_message<T>;
+
+    private:
+        array_header_ header_;
+
+        // offset of the elements from the start of the message
+        static constexpr std::size_t offset_(void)
+        {
+            return ((sizeof(array_message<T>) + alignof(T) - 1) / alignof(T)) *
+                alignof(T);
+        }
+
+        array_message(std::size_t n)
+          : header_{n, offset_(), sizeof(T), 0, n, collection_index_t{0, 0}, 0}
+        {
+            CmiAssert(reinterpret_cast<char*>(&(this->header_)) ==
+                (reinterpret_cast<char*>(this) + sizeof(message)));
+            this->total_size_ = offset_() + n * sizeof(T);
+        }
+
+    public:
+        // creates a message with room for n (uninitialized) elements
+        static message_ptr<array_message<T>> make(std::size_t n)
+        {
+            auto sz = offset_() + n * sizeof(T);
+            return message_ptr<array_message<T>>(new (sz) array_message<T>(n));
+        }
+
+        static message_ptr<array_message<T>> make(std::size_t n, const T& init)
+        {
+            auto msg = make(n);
+            std::fill(msg->begin(), msg->end(), init);
+            return msg;
+        }
+
+        std::size_t size(void) const
+        {
+            return this->header_.size;
+        }
+
+        T* data(void)
+        {
+            return reinterpret_cast<T*>((char*) this + offset_());
+        }
+
+        const T* data(void) const
+        {
+            return reinterpret_cast<const T*>((const char*) this + offset_());
+        }
+
+        T* begin(void)
+        {
+            return this->data();
+        }
+
+        T* end(void)
+        {
+            return this->data() + this->header_.size;
+        }
+
+        T& operator[](std::size_t i)
+        {
+            return this->data()[i];
+        }
+
+        const T& operator[](std::size_t i) const
+        {
+            return this->data()[i];
+        }
+    };
+
+    // creates an array message (with room for n uninitialized elements)
+    // from its kind and layout, without knowing its element type
+    inline message_ptr<> make_array_(message_kind_t kind, std::size_t offset,
+        std::size_t elem_size, std::size_t n)
+    {
+        auto sz = offset + n * elem_size;
+        auto* msg = ::new (allocate_message_(sz)) message(kind, sz);
+        new (array_header_for_(msg)) array_header_{
+            n, offset, elem_size, 0, n, collection_index_t{0, 0}, 0};
+        return message_ptr<>(msg);
+    }
+
+    template <typename T>
+    struct is_array_message_ : public std::false_type
+    {
+    };
+
+    template <typename T>
+    struct is_array_message_<array_message<T>> : public std::true_type
+    {
+    };
+
+    // define as zero to disable segmentation by default
+#ifndef CHARMLITE_SEGMENT_SIZE
+#define CHARMLITE_SEGMENT_SIZE (1 << 20)
+#endif
+
+    // contributions of array messages larger than this (in bytes) are
+    // split into segments of (about) this size, so they're combined as
+    // they arrive. pes must agree on it, so set it on every pe.
+    CpvExtern(std::size_t, segment_size_);
+
+    inline void set_segment_size(std::size_t sz)
+    {
+        CpvAccess(segment_size_) = sz;
+    }
+
+    // splits an array message into segments of (at most) n elements each,
+    // passing them to fn in order. the message itself is consumed.
+    template <typename Fn>
+    inline void split_array_(message_ptr<>&& msg, std::size_t n, const Fn& fn)
+    {
+        auto* whole = array_header_for_(msg.get());
+        auto* src = reinterpret_cast<char*>(msg.get());
+        for (std::size_t first = 0; first < whole->size; first += n)
+        {
+            auto count = std::min(n, whole->size - first);
+            auto nbytes = count * whole->elem_size;
+            auto sz = whole->offset + nbytes;
+            auto* blk = allocate_message_(size_with_trailers_(msg.get(), sz));
+            auto* dst = static_cast<char*>(blk);
+            // copy the header (with its fields and destination) then the data
+            std::memcpy(dst, src, whole->offset);
+            std::memcpy(dst + whole->offset,
+                src + whole->offset + first * whole->elem_size, nbytes);
+            message_ptr<> seg(static_cast<message*>(blk));
+            auto* part = array_header_for_(seg.get());
+            part->size = count;
+            part->first = first;
+            part->extent = whole->size;
+            seg->total_size_ = sz;
+            seg->is_segment() = true;
+            // ( each segment needs its own copy of the trailers )
+            copy_trailers_(seg.get(), msg.get());
+            fn(std::move(seg));
+        }
+        message::free(msg);
+    }
+
+    // a (partially) reassembled array message
+    struct segment_join_
+    {
+        message_ptr<> whole;
+        std::size_t received = 0;
+    };
+
+    using segment_table_t =
+        collection_flat_map_<flat_map<bcast_id_t, segment_join_>>;
+    CpvExtern(segment_table_t, segment_table_);
+
+    // copies a segment into its (local) array, returning the array once
+    // all of its segments have arrived
+    inline message_ptr<> join_segment_(message_ptr<>&& seg)
+    {
+        auto* part = array_header_for_(seg.get());
+        auto& joins = CpvAccess(segment_table_)[part->origin];
+        auto& join = joins[part->base];
+        auto& whole = join.whole;
+        if (!whole)
+        {
+            auto nbytes = part->offset + part->extent * part->elem_size;
+            auto sz = size_with_trailers_(seg.get(), nbytes);
+            whole.reset(static_cast<message*>(allocate_message_(sz)));
+            std::memcpy(whole.get(), seg.get(), part->offset);
+            auto* hdr = array_header_for_(whole.get());
+            hdr->size = part->extent;
+            hdr->first = 0;
+            whole->total_size_ = nbytes;
+            whole->is_segment() = false;
+            copy_trailers_(whole.get(), seg.get());
+        }
+        auto* dst = reinterpret_cast<char*>(whole.get()) + part->offset;
+        auto* src = reinterpret_cast<char*>(seg.get()) + part->offset;
+        std::memcpy(dst + part->first * part->elem_size, src,
+            part->size * part->elem_size);
+        join.received += part->size;
+        if (join.received < part->extent)
+        {
+            message::free(seg);
+            return message_ptr<>();
+        }
+        else
+        {
+            auto result = std::move(whole);
+            joins.erase(part->base);
+            message::free(seg);
+            return result;
+        }
+    }
+
+    // references a read-only message that's shared between the pes of a
+    // node, used to fan out broadcasts without copying their payload
+    struct shared_message_ : public plain_message<shared_message_>
+    {
+        message* payload;
+
+        shared_message_(const message_ptr<>& msg)
+          : payload(msg.get())
+        {
+            CmiAssert(msg->is_shareable());
+            CmiReference(msg.get());
+        }
+
+        ~shared_message_()
+        {
+            message::free(this->payload);
+        }
+
+        // takes (this envelope's) reference to the payload
+        message_ptr<> release(void)
+        {
+            auto* msg = this->payload;
+            this->payload = nullptr;
+            return message_ptr<>(msg);
+        }
+    };
+
+    // carries a scan's partial result (up the tree) or prefix (down it)
+    // between pes, with the (packed) value stored after its fields
+    struct scan_message_ : public plain_message<scan_message_>
+    {
+        bcast_id_t seq;
+        combiner_id_t combiner;
+        entry_id_t entry;
+        int sender;
+        bool inclusive;
+        bool upward;
+
+        scan_message_(bcast_id_t seq_, combiner_id_t combiner_,
+            entry_id_t entry_, bool inclusive_, bool upward_)
+          : seq(seq_)
+          , combiner(combiner_)
+          , entry(entry_)
+          , sender(CmiMyPe())
+          , inclusive(inclusive_)
+          , upward(upward_)
+        {
+        }
+
+        // wraps the value (which can be null, i.e., an empty prefix)
+        static message_ptr<scan_message_> make(bcast_id_t seq,
+            combiner_id_t combiner, entry_id_t entry, bool inclusive,
+            bool upward, message_ptr<>&& value)
+        {
+            pack_message(value);
+            auto sz = value ? value->total_size_ : 0;
+            message_ptr<scan_message_> msg(new (sizeof(scan_message_) + sz)
+                    scan_message_(seq, combiner, entry, inclusive, upward));
+            if (value)
+            {
+                std::memcpy(msg->value_(), value.get(), sz);
+                message::free(value);
+            }
+            msg->total_size_ += sz;
+            return msg;
+        }
+
+        // copies the value out of the envelope
+        message_ptr<> value(void)
+        {
+            auto sz = this->total_size_ - sizeof(scan_message_);
+            if (sz == 0)
+            {
+                return message_ptr<>();
+            }
+            auto* blk = allocate_message_(sz);
+            std::memcpy(blk, this->value_(), sz);
+            message_ptr<> msg(static_cast<message*>(blk));
+            unpack_message(msg);
+            return msg;
+        }
+
+    private:
+        char* value_(void)
+        {
+            return reinterpret_cast<char*>(this) + sizeof(scan_message_);
+        }
+    };
+
+    // define as zero to stop counting messages (which disables
+    // quiescence detection)
+#ifndef CHARMLITE_QUIESCENCE
+#define CHARMLITE_QUIESCENCE 1
+#endif
+
+    // the number of messages a pe handed to converse, and processed
+    struct qd_counts_
+    {
+        std::uint64_t created = 0;
+        std::uint64_t processed = 0;
+
+        bool operator==(const qd_counts_& other) const
+        {
+            return (this->created == other.created) &&
+                (this->processed == other.processed);
+        }
+
+        qd_counts_& operator+=(const qd_counts_& other)
+        {
+            this->created += other.created;
+            this->processed += other.processed;
+            return *this;
+        }
+    };
+
+    // a pe's counts, in total and for each collection messages were
+    // bound for (with the last one used cached, since traffic tends to
+    // target the same collection in bursts)
+    struct qd_counters_
+    {
+        qd_counts_ all;
+        collection_flat_map_<qd_counts_> collections;
+        collection_index_t last_id{0, 0};
+        qd_counts_* last = nullptr;
+
+        qd_counts_& operator[](const collection_index_t& id)
+        {
+            if ((this->last == nullptr) || !(this->last_id == id))
+            {
+                // ( only this inserts, so the cache never outlives a move )
+                this->last = &(this->collections[id]);
+                this->last_id = id;
+            }
+            return *(this->last);
+        }
+    };
+
+    CpvExtern(qd_counters_, qd_counters_);
+
+    inline void count_created_(destination& dst, int n)
+    {
+#if CHARMLITE_QUIESCENCE
+        auto& counters = CpvAccess(qd_counters_);
+        counters.all.created += n;
+        if (dst.kind() == kEndpoint)
+        {
+            counters[dst.endpoint().collection].created += n;
+        }
+#endif
+    }
+
+    inline void count_processed_(destination& dst)
+    {
+#if CHARMLITE_QUIESCENCE
+        auto& counters = CpvAccess(qd_counters_);
+        counters.all.processed++;
+        if (dst.kind() == kEndpoint)
+        {
+            counters[dst.endpoint().collection].processed++;
+        }
+#endif
+    }
+
     // utility function to pick optimal send mechanism
     inline void send_helper_(int pe, message_ptr<>&& msg)
     {
+        // (every message we hand to converse counts towards quiescence)
+        count_created_(msg->dst_, (pe == cmk::all) ? CmiNumPes() : 1);
         // NOTE ( we only need to pack when we're going off-node )
         if (pe == cmk::all)
         {
@@ -300,7 +1154,16 @@ namespace cmk {
         }
         else
         {
-            if (CmiNodeOf(pe) == CmiMyNode())
+            if ((pe == CmiMyPe()) && msg->has_priority())
+            {
+                // ( skip the round trip through our handler )
+                auto& prio = *(msg->prio());
+                msg->is_enqueued() = true;
+                CsdEnqueueGeneral(
+                    msg.get(), prio.queueing, prio.nbits, prio.words.data());
+                msg.release();
+            }
+            else if (CmiNodeOf(pe) == CmiMyNode())
             {
                 CmiPushPE(pe, msg.release());
             }
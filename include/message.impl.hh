@@ -2,6 +2,7 @@
 #define __CMK_MESSAGE_IMPL_HH__
 
 #include "message.hh"
+#include "serialize.hh"
 
 namespace cmk {
     template <typename T>
@@ -74,9 +75,32 @@ namespace cmk {
         }
     };
 
+    // data messages whose values can be serialized are packed automatically
     template <typename Message>
     class message_properties_extractor_<Message,
-        typename std::enable_if<!(message_properties_<Message>::value())>::type>
+        typename std::enable_if<!(message_properties_<Message>::value()) &&
+            needs_serialization_<Message>::value>::type>
+    {
+    private:
+        using serializer_type =
+            data_message_serializer_<typename Message::type>;
+
+    public:
+        static constexpr message_packer_t packer(void)
+        {
+            return &(serializer_type::pack);
+        }
+
+        static constexpr message_unpacker_t unpacker(void)
+        {
+            return &(serializer_type::unpack);
+        }
+    };
+
+    template <typename Message>
+    class message_properties_extractor_<Message,
+        typename std::enable_if<!(message_properties_<Message>::value()) &&
+            !(needs_serialization_<Message>::value)>::type>
     {
     public:
         static constexpr message_packer_t packer(void)
@@ -2,6 +2,7 @@
 #define __CMK_OPTIONS_HH__
 
 #include "common.hh"
+#include "tree.hh"
 
 namespace cmk {
     template <typename T, typename Enable = void>
@@ -41,6 +42,7 @@ namespace cmk {
     {
     protected:
         chare_index_t start_, end_, step_;
+        tree_shape tree_;
 
     public:
         collection_options_base_(const chare_index_t& start,
@@ -48,9 +50,16 @@ namespace cmk {
           : start_(start)
           , end_(end)
           , step_(step)
+          , tree_(tree_shape::kary())
         {
         }
 
+        // the shape of the collection's spanning tree
+        const tree_shape& tree(void) const
+        {
+            return this->tree_;
+        }
+
         operator bool(void) const
         {
             return (this->start_) || (this->end_) || (this->step_);
@@ -81,6 +90,12 @@ namespace cmk {
         {
         }
 
+        collection_options& with_tree(const tree_shape& shape)
+        {
+            this->tree_ = shape;
+            return *this;
+        }
+
         Index& start(void)
         {
             return converter::decode(this->start_);
@@ -0,0 +1,239 @@
+#ifndef __CMK_POOL_HH__
+#define __CMK_POOL_HH__
+
+#include <array>
+
+#include "common.hh"
+
+// define as zero to route all message allocations to CmiAlloc/CmiFree
+#ifndef CHARMLITE_MESSAGE_POOL
+#define CHARMLITE_MESSAGE_POOL 1
+#endif
+
+namespace cmk {
+    struct message_pool_stats
+    {
+        // allocations served from/missing the free-lists
+        std::size_t hits;
+        std::size_t misses;
+        // blocks returned to/spilled past the free-lists
+        std::size_t releases;
+        std::size_t spills;
+    };
+
+    // a per-pe cache of CmiAlloc'd blocks, binned by power-of-two size
+    // classes. since blocks retain their CmiAlloc header, any block of at
+    // least a class' size (including those received from the network) can
+    // be released into that class.
+    class message_pool
+    {
+    public:
+        static constexpr std::size_t min_shift_ = 6;    // 64B
+        static constexpr std::size_t num_classes_ = 12;    // ... 128KiB
+        static constexpr std::size_t default_capacity_ = 64;
+        static constexpr std::size_t nil_class_ = num_classes_;
+
+    private:
+        // free blocks are chained through their first word
+        struct node_
+        {
+            node_* next;
+        };
+
+        std::array<node_*, num_classes_> heads_;
+        std::array<std::size_t, num_classes_> counts_;
+        std::array<std::size_t, num_classes_> capacities_;
+        message_pool_stats stats_;
+
+    public:
+        message_pool(void)
+          : stats_{0, 0, 0, 0}
+        {
+            heads_.fill(nullptr);
+            counts_.fill(0);
+            capacities_.fill(default_capacity_);
+        }
+
+        message_pool(const message_pool&) = delete;
+
+        ~message_pool()
+        {
+            this->drain();
+        }
+
+        static constexpr std::size_t class_size(std::size_t cls)
+        {
+            return (std::size_t) 1 << (cls + min_shift_);
+        }
+
+        // smallest class that can satisfy a request of sz bytes
+        static std::size_t class_for_alloc(std::size_t sz)
+        {
+            for (std::size_t cls = 0; cls < num_classes_; cls++)
+            {
+                if (sz <= class_size(cls))
+                {
+                    return cls;
+                }
+            }
+            return nil_class_;
+        }
+
+        // largest class that fits within a block of sz bytes
+        // ( oversized blocks are not retained )
+        static std::size_t class_for_release(std::size_t sz)
+        {
+            auto cls = nil_class_;
+            if (sz >= class_size(num_classes_))
+            {
+                return cls;
+            }
+            for (std::size_t i = 0; i < num_classes_; i++)
+            {
+                if (class_size(i) <= sz)
+                {
+                    cls = i;
+                }
+                else
+                {
+                    break;
+                }
+            }
+            return cls;
+        }
+
+        void* allocate(std::size_t sz)
+        {
+            auto cls = class_for_alloc(sz);
+            if (cls == nil_class_)
+            {
+                this->stats_.misses++;
+                return CmiAlloc(sz);
+            }
+            auto*& head = this->heads_[cls];
+            if (head == nullptr)
+            {
+                this->stats_.misses++;
+                return CmiAlloc(class_size(cls));
+            }
+            else
+            {
+                auto* blk = head;
+                head = blk->next;
+                this->counts_[cls]--;
+                this->stats_.hits++;
+                return blk;
+            }
+        }
+
+        void release(void* blk)
+        {
+            // shared blocks (e.g., via CmiReference) go back to converse
+            auto cls = (CmiGetReference(blk) == 1) ?
+                class_for_release(CmiSize(blk)) :
+                nil_class_;
+            if ((cls == nil_class_) ||
+                (this->counts_[cls] >= this->capacities_[cls]))
+            {
+                this->stats_.spills++;
+                CmiFree(blk);
+            }
+            else
+            {
+                auto* node = static_cast<node_*>(blk);
+                node->next = this->heads_[cls];
+                this->heads_[cls] = node;
+                this->counts_[cls]++;
+                this->stats_.releases++;
+            }
+        }
+
+        // sets the maximum number of cached blocks for the class
+        // serving allocations of sz bytes, trimming it if needed
+        void set_capacity(std::size_t sz, std::size_t capacity)
+        {
+            auto cls = class_for_alloc(sz);
+            CmiEnforceMsg(cls != nil_class_, "size exceeds largest class");
+            this->capacities_[cls] = capacity;
+            this->trim_(cls);
+        }
+
+        void set_capacity(std::size_t capacity)
+        {
+            for (std::size_t cls = 0; cls < num_classes_; cls++)
+            {
+                this->capacities_[cls] = capacity;
+                this->trim_(cls);
+            }
+        }
+
+        const message_pool_stats& stats(void) const
+        {
+            return this->stats_;
+        }
+
+        void reset_stats(void)
+        {
+            new (&(this->stats_)) message_pool_stats{0, 0, 0, 0};
+        }
+
+        // returns all cached blocks to converse
+        void drain(void)
+        {
+            for (std::size_t cls = 0; cls < num_classes_; cls++)
+            {
+                auto capacity = this->capacities_[cls];
+                this->capacities_[cls] = 0;
+                this->trim_(cls);
+                this->capacities_[cls] = capacity;
+            }
+        }
+
+    private:
+        void trim_(std::size_t cls)
+        {
+            auto*& head = this->heads_[cls];
+            while (this->counts_[cls] > this->capacities_[cls])
+            {
+                auto* blk = head;
+                head = blk->next;
+                this->counts_[cls]--;
+                CmiFree(blk);
+            }
+        }
+    };
+
+    CpvExtern(message_pool, message_pool_);
+
+    inline void* allocate_message_(std::size_t sz)
+    {
+#if CHARMLITE_MESSAGE_POOL
+        return CpvAccess(message_pool_).allocate(sz);
+#else
+        return CmiAlloc(sz);
+#endif
+    }
+
+    inline void free_message_(void* blk)
+    {
+#if CHARMLITE_MESSAGE_POOL
+        CpvAccess(message_pool_).release(blk);
+#else
+        CmiFree(blk);
+#endif
+    }
+
+    // configures this pe's message pool (in number of blocks)
+    inline void set_message_pool_capacity(
+        std::size_t sz, std::size_t capacity)
+    {
+        CpvAccess(message_pool_).set_capacity(sz, capacity);
+    }
+
+    inline const message_pool_stats& get_message_pool_stats(void)
+    {
+        return CpvAccess(message_pool_).stats();
+    }
+}    // namespace cmk
+
+#endif
@@ -1,10 +1,13 @@
 #ifndef __CMK_PROXY_HH__
 #define __CMK_PROXY_HH__
 
+#include "aggregator.hh"
 #include "callback.hh"
 #include "chare.hh"
 #include "ep.hh"
+#include "gather.hh"
 #include "locmgr.hh"
+#include "section.hh"
 
 namespace cmk {
 
@@ -48,6 +51,41 @@ namespace cmk {
     template <typename... Args>
     using pack_helper_t = typename pack_helper<Args...>::type;
 
+    // names a subset of a collection's elements, whose pes form a tree
+    // (rooted at the pe that created it) that's cached as it's described
+    template <typename T>
+    class section_proxy
+    {
+        collection_index_t id_;
+        section_index_t section_;
+
+    public:
+        section_proxy(const collection_index_t& id, const section_index_t& sid)
+          : id_(id)
+          , section_(sid)
+        {
+        }
+
+        const section_index_t& section(void) const
+        {
+            return this->section_;
+        }
+
+        // sends msg to each member's Fn, fanning out over the section's tree
+        // (rather than over the whole collection's)
+        template <typename Message, member_fn_t<T, Message> Fn>
+        void multicast(message_ptr<Message>&& msg) const
+        {
+            auto env = section_message_::make(this->section_,
+                kSectionMulticast, nullptr, 0,
+                mutable_message_(std::move(msg)));
+            env->entry = entry<member_fn_t<T, Message>, Fn>();
+            new (&(env->dst_)) destination(
+                this->id_, pe_root_index_(this->section_.pe_), env->entry);
+            cmk::send(std::move(env));
+        }
+    };
+
     class element_proxy_base_
     {
     private:
@@ -92,12 +130,51 @@ namespace cmk {
             cmk::send(std::move(msg));
         }
 
-        template <typename Message, member_fn_t<T, Message> Fn>
+        // inline sends invoke the entry method immediately when the
+        // element is local (opted into per-entry via cmk::inline_entry)
+        template <typename Message, member_fn_t<T, Message> Fn,
+            bool Inline = inline_entry<member_fn_t<T, Message>, Fn>::value>
         void send(message_ptr<Message>&& msg) const
         {
-            new (&(msg->dst_)) destination(
+            auto base = mutable_message_(std::move(msg));
+            new (&(base->dst_)) destination(
                 this->id_, this->idx_, entry<member_fn_t<T, Message>, Fn>());
-            cmk::send(std::move(msg));
+            base->is_inline() = Inline;
+            cmk::send(std::move(base));
+        }
+
+        // as above, but the message is queued by its priority (rather
+        // than in order) on the receiving pe
+        template <typename Message, member_fn_t<T, Message> Fn>
+        void send(message_ptr<Message>&& msg, const priority& prio) const
+        {
+            auto base = mutable_message_(std::move(msg));
+            new (&(base->dst_)) destination(
+                this->id_, this->idx_, entry<member_fn_t<T, Message>, Fn>());
+            set_priority_(base, prio);
+            cmk::send(std::move(base));
+        }
+
+        // as above, but buffers the message with others bound for the
+        // same pe (see cmk::flush_aggregates), which amortizes the cost
+        // of sending many small messages
+        template <typename Message, member_fn_t<T, Message> Fn>
+        void send_aggregated(message_ptr<Message>&& msg) const
+        {
+            auto base = mutable_message_(std::move(msg));
+            new (&(base->dst_)) destination(
+                this->id_, this->idx_, entry<member_fn_t<T, Message>, Fn>());
+            auto* obj = cmk::lookup(this->id_);
+            if (obj == nullptr)
+            {
+                // (the collection's layout is unknown until it's created)
+                cmk::send(std::move(base));
+            }
+            else
+            {
+                CpvAccess(aggregator_).send(
+                    obj->home_pe(this->idx_), std::move(base));
+            }
         }
 
         template <typename Message, member_fn_t<T, Message> Fn>
@@ -111,19 +188,110 @@ namespace cmk {
         template <typename Message, combiner_fn_t<Message> Combiner>
         void contribute(
             message_ptr<Message>&& msg, const cmk::callback<Message>& cb) const
+        {
+            this->prepare_contribution_<Message, Combiner>(msg, cb);
+            // send the contribution...
+            cmk::lookup(this->id_)->contribute(std::move(msg));
+        }
+
+        // contributes to a reduction over the members of a section
+        template <typename Message, combiner_fn_t<Message> Combiner>
+        void contribute(const section_proxy<T>& sec,
+            message_ptr<Message>&& msg, const cmk::callback<Message>& cb) const
+        {
+            this->prepare_contribution_<Message, Combiner>(msg, cb);
+            cmk::lookup(this->id_)->contribute(sec.section(), std::move(msg));
+        }
+
+        // arrives at a barrier, invoking cb once every element has
+        // ( unlike a nop reduction, elements don't allocate messages )
+        void barrier(const cmk::callback<message>& cb) const
+        {
+            continuation_ cont;
+            cb.imprint(cont);
+            cmk::lookup(this->id_)->barrier(this->idx_, cont);
+        }
+
+        // contributes to a reduction whose result is delivered to each
+        // element's Fn, broadcast straight from the reduction's root
+        template <typename Message, combiner_fn_t<Message> Combiner,
+            member_fn_t<T, Message> Fn>
+        void all_reduce(message_ptr<Message>&& msg) const
+        {
+            auto cb = cmk::callback<Message>(this->id_, chare_bcast_root_,
+                entry<member_fn_t<T, Message>, Fn>());
+            this->contribute<Message, Combiner>(std::move(msg), cb);
+        }
+
+        // delivers each element (to its Fn) the combination of its own
+        // contribution with those of the elements preceding it
+        template <typename Message, combiner_fn_t<Message> Combiner,
+            member_fn_t<T, Message> Fn>
+        void inclusive_scan(message_ptr<Message>&& msg) const
+        {
+            this->scan_<Message, Combiner, Fn>(std::move(msg), true);
+        }
+
+        // as above, excluding the element's own contribution
+        // ( so the very first element receives a null message )
+        template <typename Message, combiner_fn_t<Message> Combiner,
+            member_fn_t<T, Message> Fn>
+        void exclusive_scan(message_ptr<Message>&& msg) const
+        {
+            this->scan_<Message, Combiner, Fn>(std::move(msg), false);
+        }
+
+        // contributes this element's values to a gather, whose result holds
+        // every element's values (in index order) once they all have
+        template <typename Value>
+        void gather(message_ptr<array_message<Value>>&& msg,
+            const cmk::callback<gather_message<Value>>& cb) const
+        {
+            continuation_ cont;
+            cb.imprint(cont);
+            new (&(msg->dst_)) destination(this->id_, this->idx_, nil_entry_);
+            cmk::lookup(this->id_)->gather(std::move(msg),
+                message_helper_<gather_message<Value>>::kind_, cont);
+        }
+
+        // sends each entry's values to its element, which receives those
+        // from every element (in index order of their sources) at Fn. the
+        // values for each pe travel together, as one message
+        template <typename Value, member_fn_t<T, gather_message<Value>> Fn>
+        void all_to_all(message_ptr<gather_message<Value>>&& msg) const
+        {
+            auto base = mutable_message_(std::move(msg));
+            auto* hdr = gather_header_for_(base.get());
+            hdr->entry = entry<member_fn_t<T, gather_message<Value>>, Fn>();
+            new (&(base->dst_)) destination(this->id_, this->idx_, hdr->entry);
+            cmk::lookup(this->id_)->all_to_all(std::move(base));
+        }
+
+    private:
+        template <typename Message, combiner_fn_t<Message> Combiner>
+        void prepare_contribution_(message_ptr<Message>& msg,
+            const cmk::callback<Message>& cb) const
         {
             // set the contribution's combiner
             msg->has_combiner() = true;
             new (&(msg->dst_)) destination(this->id_, this->idx_,
                 combiner_helper_<Message, Combiner>::id_);
             // set the contribution's continuation
-            auto cont = msg->has_continuation();
-            CmiAssertMsg(
-                !cont, "continuation of contribution will be overriden");
-            cont = true;
-            cb.imprint(*(msg->continuation()));
-            // send the contribution...
-            cmk::lookup(this->id_)->contribute(std::move(msg));
+            CmiAssertMsg(!msg->has_continuation(),
+                "continuation of contribution will be overriden");
+            continuation_ cont;
+            cb.imprint(cont);
+            set_continuation_(reinterpret_cast<message_ptr<>&>(msg), cont);
+        }
+
+        template <typename Message, combiner_fn_t<Message> Combiner,
+            member_fn_t<T, Message> Fn>
+        void scan_(message_ptr<Message>&& msg, bool inclusive) const
+        {
+            new (&(msg->dst_)) destination(
+                this->id_, this->idx_, entry<member_fn_t<T, Message>, Fn>());
+            cmk::lookup(this->id_)->scan(std::move(msg),
+                combiner_helper_<Message, Combiner>::id_, inclusive);
         }
     };
 
@@ -154,13 +322,76 @@ namespace cmk {
                 entry<member_fn_t<T, Message>, Fn>());
         }
 
+        // entry methods that accept const messages will share the
+        // broadcast message with the other elements on their node
         template <typename Message, member_fn_t<T, Message> Fn>
         void broadcast(message_ptr<Message>&& msg) const
         {
+            auto base = mutable_message_(std::move(msg));
             // send a message to the broadcast root
-            new (&msg->dst_) destination(this->id_, chare_bcast_root_,
+            new (&base->dst_) destination(this->id_, chare_bcast_root_,
                 entry<member_fn_t<T, Message>, Fn>());
-            cmk::send(std::move(msg));
+            cmk::send(std::move(base));
+        }
+
+        // as above, with every element's copy queued by its priority
+        template <typename Message, member_fn_t<T, Message> Fn>
+        void broadcast(message_ptr<Message>&& msg, const priority& prio) const
+        {
+            auto base = mutable_message_(std::move(msg));
+            set_priority_(base, prio);
+            new (&base->dst_) destination(this->id_, chare_bcast_root_,
+                entry<member_fn_t<T, Message>, Fn>());
+            cmk::send(std::move(base));
+        }
+
+        // creates a section of the given elements (whose tree is rooted
+        // at this pe)
+        section_proxy<T> section(const std::vector<index_type>& indices) const
+        {
+            CmiEnforceMsg(!indices.empty(), "sections must have members");
+            section_index_t sid;
+            next_index_(sid);
+            std::vector<chare_index_t> members;
+            for (auto& idx : indices)
+            {
+                members.emplace_back(index_view<index_type>::encode(idx));
+            }
+            // describe the section to (our part of) its tree
+            auto env = section_message_::make(sid, kSectionDescribe,
+                members.data(), members.size(), message_ptr<>());
+            new (&(env->dst_))
+                destination(this->id_, pe_root_index_(CmiMyPe()), nil_entry_);
+            cmk::send(std::move(env));
+            return section_proxy<T>(this->id_, sid);
+        }
+
+        // as above, with every step-th index in [start, end)
+        section_proxy<T> section(const index_type& start,
+            const index_type& end, const index_type& step = 1) const
+        {
+            std::vector<index_type> indices;
+            for (auto idx = start; idx < end; idx += step)
+            {
+                indices.emplace_back(idx);
+            }
+            return this->section(indices);
+        }
+
+        // sends each entry's values to its element's Fn (as an array
+        // message), passing each subtree its entries as a single message
+        template <typename Value, member_fn_t<T, array_message<Value>> Fn>
+        void scatter(message_ptr<gather_message<Value>>&& msg) const
+        {
+            auto base = mutable_message_(std::move(msg));
+            auto* hdr = gather_header_for_(base.get());
+            hdr->entry = entry<member_fn_t<T, array_message<Value>>, Fn>();
+            hdr->phase = kScatterPhase;
+            // ( between pes, it travels as an untyped part )
+            base->kind_ = message_helper_<gather_part_>::kind_;
+            new (&base->dst_)
+                destination(this->id_, chare_bcast_root_, hdr->entry);
+            cmk::send(std::move(base));
         }
 
         operator collection_index_t(void) const
@@ -209,7 +440,7 @@ namespace cmk {
         {
             collection_index_t id;
             base_type::next_index_(id);
-            auto a_msg = cmk::make_message<message<>>();
+            auto a_msg = cmk::make_message<message>();
             new (&a_msg->dst_)
                 destination(id, chare_bcast_root_, constructor<T, void>());
             call_construtor_<Mapper>(id, &opts, std::move(a_msg));
@@ -281,6 +512,15 @@ namespace cmk {
 
         template <typename... Args>
         static group_proxy<T> construct(Args&&... args)
+        {
+            return construct_with_tree(
+                tree_shape::kary(), std::forward<Args>(args)...);
+        }
+
+        // constructs a group whose collectives use the given tree
+        template <typename... Args>
+        static group_proxy<T> construct_with_tree(
+            const tree_shape& shape, Args&&... args)
         {
             collection_index_t id;
             base_type::next_index_(id);
@@ -308,6 +548,7 @@ namespace cmk {
                 auto* opts =
                     reinterpret_cast<options_type*>(base + sizeof(message));
                 new (opts) options_type(CmiNumPes());
+                opts->with_tree(shape);
                 // copy the argument message onto it
                 pack_and_free_(base + offset, std::move(a_msg));
                 // broadcast the conjoined message to all PEs
@@ -0,0 +1,244 @@
+#ifndef __CMK_QUIESCENCE_HH__
+#define __CMK_QUIESCENCE_HH__
+
+#include "callback.hh"
+#include "tree.hh"
+
+namespace cmk {
+    // detections over every message (rather than a collection's)
+    inline const collection_index_t& qd_everything_(void)
+    {
+        static const collection_index_t everything{
+            std::numeric_limits<std::uint32_t>::max(),
+            std::numeric_limits<std::uint32_t>::max()};
+        return everything;
+    }
+
+    enum qd_kind_ : std::uint8_t
+    {
+        // asks pe0 to start detecting
+        kQdStart = 0,
+        // collects pes' counts down (then up) a tree spanning them
+        kQdWave,
+        kQdReply
+    };
+
+    // the control messages of quiescence detection, which bypass our
+    // converse handler (so they are not counted themselves)
+    struct qd_message_
+    {
+        std::array<char, CmiMsgHeaderSizeBytes> core_;
+        qd_kind_ kind;
+        collection_index_t target;
+        qd_counts_ counts;
+        continuation_ cont;
+    };
+
+    void qd_handler_(void*);
+
+    // detects quiescence with waves that sum the pes' counts, declaring it
+    // once two consecutive waves see the same (balanced) counts. since no
+    // message was sent or processed between them, none can be in flight
+    class quiescence_detector_
+    {
+        struct detection_
+        {
+            std::vector<continuation_> conts;
+            qd_counts_ last;
+            bool balanced = false;
+        };
+
+        struct wave_
+        {
+            std::size_t pending;
+            qd_counts_ sum;
+        };
+
+        int handler_;
+        // this pe's place in the tree (computed on first use)
+        int parent_;
+        std::vector<int> children_;
+        bool valid_;
+        // waves passing through this pe (by target)
+        collection_flat_map_<wave_> waves_;
+        // (on pe0) the detections in progress (by target)
+        collection_flat_map_<detection_> detections_;
+
+    public:
+        quiescence_detector_(void)
+          : handler_(-1)
+          , parent_(-1)
+          , valid_(false)
+        {
+        }
+
+        quiescence_detector_(const quiescence_detector_&) = delete;
+
+        void initialize(void)
+        {
+            this->handler_ = CmiRegisterHandler(qd_handler_);
+        }
+
+        // asks pe0 to invoke cont once target is quiescent
+        void start(
+            const collection_index_t& target, const continuation_& cont)
+        {
+            auto* msg = this->make_(kQdStart, target);
+            new (&(msg->cont)) continuation_(cont);
+            this->send_(0, msg);
+        }
+
+        void handle(qd_message_* msg)
+        {
+            auto target = msg->target;
+            switch (msg->kind)
+            {
+            case kQdStart:
+            {
+                auto& detection = this->detections_[target];
+                detection.conts.emplace_back(msg->cont);
+                // only the first request starts a wave
+                if (detection.conts.size() == 1)
+                {
+                    this->begin_wave_(target);
+                }
+                break;
+            }
+            case kQdWave:
+                this->begin_wave_(target);
+                break;
+            case kQdReply:
+            {
+                auto& wave = this->waves_.find(target)->second;
+                wave.sum += msg->counts;
+                wave.pending--;
+                this->try_finish_wave_(target);
+                break;
+            }
+            default:
+                CmiAbort("invalid quiescence message");
+            }
+            CmiFree(msg);
+        }
+
+    private:
+        qd_message_* make_(qd_kind_ kind, const collection_index_t& target)
+        {
+            auto* msg =
+                static_cast<qd_message_*>(CmiAlloc(sizeof(qd_message_)));
+            CmiSetHandler(msg, this->handler_);
+            msg->kind = kind;
+            msg->target = target;
+            return msg;
+        }
+
+        void send_(int pe, qd_message_* msg)
+        {
+            CmiSyncSendAndFree(pe, sizeof(qd_message_), (char*) msg);
+        }
+
+        void validate_(void)
+        {
+            if (!this->valid_)
+            {
+                build_tree_(tree_shape::kary(), all_pes_(), CmiMyPe(),
+                    this->parent_, this->children_);
+                this->valid_ = true;
+            }
+        }
+
+        const qd_counts_& counts_for_(const collection_index_t& target)
+        {
+            auto& counters = CpvAccess(qd_counters_);
+            return (target == qd_everything_()) ? counters.all :
+                                                  counters[target];
+        }
+
+        void begin_wave_(const collection_index_t& target)
+        {
+            this->validate_();
+            auto& wave = this->waves_[target];
+            wave.pending = this->children_.size();
+            wave.sum = this->counts_for_(target);
+            for (auto& child : this->children_)
+            {
+                this->send_(child, this->make_(kQdWave, target));
+            }
+            this->try_finish_wave_(target);
+        }
+
+        void try_finish_wave_(const collection_index_t& target)
+        {
+            auto search = this->waves_.find(target);
+            if (search->second.pending > 0)
+            {
+                return;
+            }
+            auto sum = search->second.sum;
+            this->waves_.erase(search);
+            if (this->parent_ >= 0)
+            {
+                auto* msg = this->make_(kQdReply, target);
+                msg->counts = sum;
+                this->send_(this->parent_, msg);
+            }
+            else
+            {
+                this->finish_wave_(target, sum);
+            }
+        }
+
+        // (on pe0) decides whether target is quiescent
+        void finish_wave_(
+            const collection_index_t& target, const qd_counts_& sum)
+        {
+            auto search = this->detections_.find(target);
+            auto& detection = search->second;
+            auto balanced = (sum.created == sum.processed);
+            if (balanced && detection.balanced && (detection.last == sum))
+            {
+                auto conts = std::move(detection.conts);
+                this->detections_.erase(search);
+                for (auto& cont : conts)
+                {
+                    auto msg = cmk::make_message<message>();
+                    new (&(msg->dst_)) destination(cont.dst);
+                    if (cont.prio)
+                    {
+                        set_priority_(msg, cont.prio);
+                    }
+                    cmk::send(std::move(msg));
+                }
+            }
+            else
+            {
+                detection.last = sum;
+                detection.balanced = balanced;
+                // the next wave waits behind whatever we have queued
+                this->send_(CmiMyPe(), this->make_(kQdWave, target));
+            }
+        }
+    };
+
+    CpvExtern(quiescence_detector_, quiescence_detector_);
+
+    // invokes cb once the whole system is quiescent, i.e., no messages are
+    // in flight or being processed
+    inline void on_quiescence(const callback<message>& cb)
+    {
+        continuation_ cont;
+        cb.imprint(cont);
+        CpvAccess(quiescence_detector_).start(qd_everything_(), cont);
+    }
+
+    // as above, only counting the messages bound for a collection
+    inline void on_quiescence(
+        const collection_index_t& id, const callback<message>& cb)
+    {
+        continuation_ cont;
+        cb.imprint(cont);
+        CpvAccess(quiescence_detector_).start(id, cont);
+    }
+}    // namespace cmk
+
+#endif
@@ -2,26 +2,97 @@
 #define __CMK_REDUCTION_HH__
 
 #include "callback.hh"
+#include "chare.hh"
+#include "locmgr.hh"
 #include "message.hh"
 
-// TODO ( converse collectives should be isolated/removed )
-
 namespace cmk {
-    void* converse_combiner_(int* size, void* local, void** remote, int count)
+    // combines pe-level reductions (i.e., those started by cmk::reduce)
+    // over a tree spanning all pes. each pe numbers its reductions in the
+    // order they're started, so any number of them can be in flight
+    class pe_reducer_
     {
-        message_ptr<> lhs(static_cast<message*>(local));
-        auto comb = combiner_for(lhs);
-        CmiEnforce(comb != nullptr);
-        for (auto i = 0; i < count; i++)
+        bcast_id_t last_redn_;
+        flat_map<bcast_id_t, reducer_> reducers_;
+        // this pe's place in the tree (computed on first use)
+        int parent_;
+        std::size_t n_children_;
+        bool valid_;
+
+    public:
+        pe_reducer_(void)
+          : last_redn_(0)
+          , parent_(-1)
+          , n_children_(0)
+          , valid_(false)
         {
-            auto& msg = remote[i];
-            message_ptr<> rhs(reinterpret_cast<message*>(msg));
-            CmiReference(msg);    // yielding will call free!
-            lhs = comb(std::move(lhs), std::move(rhs));
         }
-        *size = (int) lhs->total_size_;
-        return lhs.release();
-    }
+
+        pe_reducer_(const pe_reducer_&) = delete;
+
+        bcast_id_t next(void)
+        {
+            return ++(this->last_redn_);
+        }
+
+        // combines a local contribution or a child's partial result,
+        // sending it along once all of them have arrived
+        void accept(message_ptr<>&& msg)
+        {
+            this->validate_();
+            unpack_message(msg);
+            auto redn = msg->sequence();
+            auto search = this->reducers_.find(redn);
+            if (search == std::end(this->reducers_))
+            {
+                search = this->reducers_.emplace(redn, this->n_children_).first;
+            }
+            auto& reducer = search->second;
+            auto& lhs = reducer.partial;
+            if (lhs)
+            {
+                auto comb = combiner_for(msg);
+                // retain the destination (in case the combiner resets it)
+                auto dst = msg->dst_;
+                lhs = comb(std::move(lhs), std::move(msg));
+                new (&(lhs->dst_)) destination(dst);
+                lhs->has_combiner() = true;
+            }
+            else
+            {
+                lhs = std::move(msg);
+            }
+            if (++reducer.received == reducer.expected)
+            {
+                auto result = std::move(lhs);
+                this->reducers_.erase(search);
+                if (this->parent_ < 0)
+                {
+                    result->has_combiner() = false;
+                    cmk::send(std::move(result));
+                }
+                else
+                {
+                    send_helper_(this->parent_, std::move(result));
+                }
+            }
+        }
+
+    private:
+        void validate_(void)
+        {
+            if (!this->valid_)
+            {
+                std::vector<int> children;
+                build_tree_(tree_shape::kary(), all_pes_(), CmiMyPe(),
+                    this->parent_, children);
+                this->n_children_ = children.size();
+                this->valid_ = true;
+            }
+        }
+    };
+
+    CpvExtern(pe_reducer_, pe_reducer_);
 
     template <typename Message, combiner_fn_t<Message> Combiner,
         callback_fn_t<Message> Callback>
@@ -32,11 +103,12 @@ namespace cmk {
             destination(callback_helper_<Message, Callback>::id_, 0);
         msg->has_combiner() = true;
         *(msg->combiner()) = combiner_helper_<Message, Combiner>::id_;
-        auto sz = msg->total_size_;
-        CmiReduce(msg.release(), sz, converse_combiner_);
+        auto& reducer = CpvAccess(pe_reducer_);
+        msg->sequence() = reducer.next();
+        reducer.accept(message_ptr<>(msg.release()));
     }
 
-    message_ptr<> nop(message_ptr<>&& msg, message_ptr<>&&)
+    inline message_ptr<> nop(message_ptr<>&& msg, message_ptr<>&&)
     {
         return std::move(msg);
     }
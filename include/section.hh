@@ -0,0 +1,99 @@
+#ifndef __CMK_SECTION_HH__
+#define __CMK_SECTION_HH__
+
+#include "message.hh"
+
+namespace cmk {
+    // sections are named by the pe that created them (which roots their
+    // tree) and a number that's unique to that pe
+    using section_index_t = collection_index_t;
+
+    enum section_kind_ : std::uint8_t
+    {
+        // lists the members of the receiving pe's subtree
+        kSectionDescribe = 0,
+        // carries a payload down the tree
+        kSectionMulticast,
+        // carries a partial result up the tree
+        kSectionReduce
+    };
+
+    // carries a section's description, multicasts and partial results
+    // between its pes, with its members then (packed) value stored after
+    // its fields
+    struct section_message_ : public plain_message<section_message_>
+    {
+        section_index_t section;
+        section_kind_ kind;
+        entry_id_t entry;
+        bcast_id_t seq;
+        int sender;
+        std::size_t n_members;
+
+        section_message_(const section_index_t& section_, section_kind_ kind_,
+            std::size_t n_members_)
+          : section(section_)
+          , kind(kind_)
+          , entry(nil_entry_)
+          , seq(0)
+          , sender(CmiMyPe())
+          , n_members(n_members_)
+        {
+        }
+
+        static message_ptr<section_message_> make(
+            const section_index_t& section, section_kind_ kind,
+            const chare_index_t* members, std::size_t n_members,
+            message_ptr<>&& value)
+        {
+            pack_message(value);
+            auto nbytes = value ? value->total_size_ : 0;
+            auto offset = members_offset_() + n_members * sizeof(chare_index_t);
+            message_ptr<section_message_> msg(new (offset + nbytes)
+                    section_message_(section, kind, n_members));
+            std::copy(members, members + n_members, msg->members());
+            if (value)
+            {
+                std::memcpy(
+                    reinterpret_cast<char*>(msg.get()) + offset, value.get(),
+                    nbytes);
+                message::free(value);
+            }
+            msg->total_size_ = offset + nbytes;
+            return msg;
+        }
+
+        chare_index_t* members(void)
+        {
+            return reinterpret_cast<chare_index_t*>(
+                reinterpret_cast<char*>(this) + members_offset_());
+        }
+
+        // copies the value out of the envelope (or returns null)
+        message_ptr<> value(void)
+        {
+            auto offset =
+                members_offset_() + this->n_members * sizeof(chare_index_t);
+            auto nbytes = this->total_size_ - offset;
+            if (nbytes == 0)
+            {
+                return message_ptr<>();
+            }
+            auto* blk = allocate_message_(nbytes);
+            std::memcpy(blk, reinterpret_cast<char*>(this) + offset, nbytes);
+            message_ptr<> msg(static_cast<message*>(blk));
+            unpack_message(msg);
+            return msg;
+        }
+
+    private:
+        static constexpr std::size_t members_offset_(void)
+        {
+            return ((sizeof(section_message_) + ALIGN_BYTES - 1) /
+                       ALIGN_BYTES) *
+                ALIGN_BYTES;
+        }
+    };
+}    // namespace cmk
+
+#endif
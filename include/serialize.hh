@@ -0,0 +1,376 @@
+#ifndef __CMK_SERIALIZE_HH__
+#define __CMK_SERIALIZE_HH__
+
+#include <map>
+#include <string>
+#include <tuple>
+
+#include "message.hh"
+
+namespace cmk {
+    enum pup_mode_ : std::uint8_t
+    {
+        kPupSizing = 0,
+        kPupPacking,
+        kPupUnpacking
+    };
+
+    // specialize this to serialize a type, i.e., with a static
+    // apply(Serializer&, T&) that passes its parts to the serializer
+    template <typename T, typename Enable = void>
+    struct pup_helper;
+
+    // whether a type can be serialized (i.e., pup_helper is defined)
+    template <typename T, typename Enable = void>
+    struct is_serializable : public std::false_type
+    {
+    };
+
+    template <typename T>
+    struct is_serializable<T, decltype((void) sizeof(pup_helper<T>))>
+      : public std::true_type
+    {
+    };
+
+    // walks a value to size, pack or unpack it. the same code does all
+    // three (i.e., pup), so their layouts always agree
+    template <pup_mode_ Mode>
+    class serializer
+    {
+        char* base_;
+        std::size_t offset_;
+
+    public:
+        explicit serializer(char* base = nullptr)
+          : base_(base)
+          , offset_(0)
+        {
+        }
+
+        bool sizing(void) const
+        {
+            return Mode == kPupSizing;
+        }
+
+        bool packing(void) const
+        {
+            return Mode == kPupPacking;
+        }
+
+        bool unpacking(void) const
+        {
+            return Mode == kPupUnpacking;
+        }
+
+        // the number of bytes walked so far
+        std::size_t size(void) const
+        {
+            return this->offset_;
+        }
+
+        // copies nbytes to (or from) the buffer
+        void bytes(void* ptr, std::size_t nbytes)
+        {
+            if (Mode == kPupPacking)
+            {
+                std::memcpy(this->base_ + this->offset_, ptr, nbytes);
+            }
+            else if (Mode == kPupUnpacking)
+            {
+                std::memcpy(ptr, this->base_ + this->offset_, nbytes);
+            }
+            this->offset_ += nbytes;
+        }
+
+        template <typename T>
+        serializer<Mode>& operator|(T& value)
+        {
+            static_assert(is_serializable<T>::value,
+                "type is not serializable (define a pup method)");
+            pup_helper<T>::apply(*this, value);
+            return *this;
+        }
+    };
+
+    using sizer = serializer<kPupSizing>;
+    using packer = serializer<kPupPacking>;
+    using unpacker = serializer<kPupUnpacking>;
+
+    // user-defined types serialize their fields through a pup method,
+    // i.e., template <typename Serializer> void pup(Serializer& s)
+    template <typename T>
+    class has_pup_method_
+    {
+        template <typename U>
+        static auto check(std::nullptr_t)
+            -> decltype(std::declval<U&>().pup(std::declval<sizer&>()));
+        template <typename U>
+        static std::nullptr_t check(...);
+
+    public:
+        static constexpr bool value =
+            std::is_same<void, decltype(check<T>(nullptr))>::value;
+    };
+
+    template <typename... Ts>
+    struct all_serializable_;
+
+    template <>
+    struct all_serializable_<> : public std::true_type
+    {
+    };
+
+    template <typename T, typename... Ts>
+    struct all_serializable_<T, Ts...>
+      : public std::integral_constant<bool,
+            is_serializable<T>::value && all_serializable_<Ts...>::value>
+    {
+    };
+
+    template <typename T>
+    struct pup_helper<T,
+        typename std::enable_if<std::is_trivially_copyable<T>::value>::type>
+    {
+        template <typename Serializer>
+        static void apply(Serializer& s, T& value)
+        {
+            s.bytes(&value, sizeof(T));
+        }
+    };
+
+    template <typename T>
+    struct pup_helper<T,
+        typename std::enable_if<!std::is_trivially_copyable<T>::value &&
+            std::is_default_constructible<T>::value &&
+            has_pup_method_<T>::value>::type>
+    {
+        template <typename Serializer>
+        static void apply(Serializer& s, T& value)
+        {
+            value.pup(s);
+        }
+    };
+
+    // (containers store their size ahead of their elements)
+    template <typename Serializer>
+    inline std::size_t pup_size_(Serializer& s, std::size_t size)
+    {
+        s | size;
+        return size;
+    }
+
+    template <>
+    struct pup_helper<std::string>
+    {
+        template <typename Serializer>
+        static void apply(Serializer& s, std::string& value)
+        {
+            auto size = pup_size_(s, value.size());
+            if (s.unpacking())
+            {
+                value.resize(size);
+            }
+            s.bytes(&(value[0]), size);
+        }
+    };
+
+    template <typename T, typename Alloc>
+    struct pup_helper<std::vector<T, Alloc>,
+        typename std::enable_if<is_serializable<T>::value &&
+            std::is_default_constructible<T>::value &&
+            !std::is_same<T, bool>::value>::type>
+    {
+        template <typename Serializer>
+        static void apply(Serializer& s, std::vector<T, Alloc>& value)
+        {
+            auto size = pup_size_(s, value.size());
+            if (s.unpacking())
+            {
+                value.resize(size);
+            }
+            if (std::is_trivially_copyable<T>::value)
+            {
+                // ( one copy for the lot )
+                s.bytes(value.data(), size * sizeof(T));
+            }
+            else
+            {
+                for (auto& elt : value)
+                {
+                    s | elt;
+                }
+            }
+        }
+    };
+
+    template <typename K, typename V, typename Compare, typename Alloc>
+    struct pup_helper<std::map<K, V, Compare, Alloc>,
+        typename std::enable_if<all_serializable_<K, V>::value &&
+            std::is_default_constructible<K>::value &&
+            std::is_default_constructible<V>::value>::type>
+    {
+        template <typename Serializer>
+        static void apply(Serializer& s, std::map<K, V, Compare, Alloc>& value)
+        {
+            auto size = pup_size_(s, value.size());
+            if (s.unpacking())
+            {
+                value.clear();
+                for (std::size_t i = 0; i < size; i++)
+                {
+                    K key;
+                    s | key;
+                    s | value[key];
+                }
+            }
+            else
+            {
+                for (auto& pair : value)
+                {
+                    s | const_cast<K&>(pair.first);
+                    s | pair.second;
+                }
+            }
+        }
+    };
+
+    template <typename A, typename B>
+    struct pup_helper<std::pair<A, B>,
+        typename std::enable_if<
+            !std::is_trivially_copyable<std::pair<A, B>>::value &&
+            all_serializable_<A, B>::value>::type>
+    {
+        template <typename Serializer>
+        static void apply(Serializer& s, std::pair<A, B>& value)
+        {
+            s | value.first;
+            s | value.second;
+        }
+    };
+
+    template <std::size_t I, std::size_t N>
+    struct pup_tuple_
+    {
+        template <typename Serializer, typename Tuple>
+        static void apply(Serializer& s, Tuple& value)
+        {
+            s | std::get<I>(value);
+            pup_tuple_<I + 1, N>::apply(s, value);
+        }
+    };
+
+    template <std::size_t N>
+    struct pup_tuple_<N, N>
+    {
+        template <typename Serializer, typename Tuple>
+        static void apply(Serializer&, Tuple&)
+        {
+        }
+    };
+
+    template <typename... Ts>
+    struct pup_helper<std::tuple<Ts...>,
+        typename std::enable_if<
+            !std::is_trivially_copyable<std::tuple<Ts...>>::value &&
+            all_serializable_<Ts...>::value>::type>
+    {
+        template <typename Serializer>
+        static void apply(Serializer& s, std::tuple<Ts...>& value)
+        {
+            pup_tuple_<0, sizeof...(Ts)>::apply(s, value);
+        }
+    };
+
+    // whether a type's bytes are self-contained (so it can be copied as-is
+    // between address spaces, even if it's not trivially copyable)
+    template <typename T>
+    struct is_bitwise_ : public std::is_trivially_copyable<T>
+    {
+    };
+
+    template <typename A, typename B>
+    struct is_bitwise_<std::pair<A, B>>
+      : public std::integral_constant<bool,
+            is_bitwise_<A>::value && is_bitwise_<B>::value>
+    {
+    };
+
+    template <>
+    struct is_bitwise_<std::tuple<>> : public std::true_type
+    {
+    };
+
+    template <typename T, typename... Ts>
+    struct is_bitwise_<std::tuple<T, Ts...>>
+      : public std::integral_constant<bool,
+            is_bitwise_<T>::value && is_bitwise_<std::tuple<Ts...>>::value>
+    {
+    };
+
+    // whether a data message's value has to be serialized to leave its
+    // pe's address space (i.e., it's more than a bag of bytes)
+    template <typename Message>
+    struct needs_serialization_ : public std::false_type
+    {
+    };
+
+    template <typename T>
+    struct needs_serialization_<data_message<T>>
+      : public std::integral_constant<bool,
+            !is_bitwise_<T>::value &&
+                std::is_default_constructible<T>::value &&
+                is_serializable<T>::value>
+    {
+    };
+
+    // packs data messages by serializing their value after their fields,
+    // into a single (exactly sized) allocation. the value is then rebuilt
+    // in place, straight from that allocation, when it's unpacked
+    template <typename T>
+    struct data_message_serializer_
+    {
+        using message_type = data_message<T>;
+
+        static constexpr std::size_t offset_(void)
+        {
+            return ((sizeof(message_type) + ALIGN_BYTES - 1) / ALIGN_BYTES) *
+                ALIGN_BYTES;
+        }
+
+        static void pack(message_ptr<>& msg)
+        {
+            auto* src = static_cast<message_type*>(msg.get());
+            auto& value = src->value();
+            sizer s;
+            s | value;
+            auto sz = offset_() + s.size();
+            CmiAssertMsg(sz <= message::max_size(), "message is too large");
+            // ( leaving room for the trailers, so they're appended in place )
+            auto* blk = static_cast<char*>(
+                allocate_message_(size_with_trailers_(src, sz)));
+            // copy the common fields (the value's storage is left unused)
+            std::memcpy(blk, src, sizeof(message));
+            packer p(blk + offset_());
+            p | value;
+            message_ptr<> dst(reinterpret_cast<message*>(blk));
+            dst->total_size_ = sz;
+            // ( the value is packed, so nothing may pack it again )
+            dst->is_packed() = true;
+            // ( the trailers aren't part of the common fields )
+            copy_trailers_(dst.get(), src);
+            value.~T();
+            message::free(msg);
+            msg = std::move(dst);
+        }
+
+        static void unpack(message_ptr<>& msg)
+        {
+            auto* dst = static_cast<message_type*>(msg.get());
+            auto* value = ::new (&(dst->value())) T();
+            unpacker u(reinterpret_cast<char*>(dst) + offset_());
+            u | *value;
+        }
+    };
+}    // namespace cmk
+
+#endif
@@ -0,0 +1,219 @@
+#ifndef __CMK_STORAGE_HH__
+#define __CMK_STORAGE_HH__
+
+#include "chare.hh"
+
+namespace cmk {
+
+    // maps indices within a bounded range onto [0, extent)
+    template <typename Index, typename Enable = void>
+    struct dense_ordinal_
+    {
+        static constexpr bool value = false;
+
+        dense_ordinal_(const collection_options<Index>&) {}
+
+        std::size_t extent(void) const
+        {
+            return 0;
+        }
+
+        bool operator()(const chare_index_t&, std::size_t&) const
+        {
+            return false;
+        }
+    };
+
+    template <typename Index>
+    struct dense_ordinal_<Index,
+        typename std::enable_if<std::is_integral<Index>::value>::type>
+    {
+        static constexpr bool value = true;
+
+        Index start_, step_;
+        std::size_t extent_;
+
+        dense_ordinal_(const collection_options<Index>& opts)
+          : start_(opts.start())
+          , step_(opts.step())
+          , extent_(0)
+        {
+            // only ascending ranges are densely stored
+            if (opts && (opts.step() > 0) && (opts.end() > opts.start()))
+            {
+                auto span = (std::size_t)(opts.end() - opts.start());
+                this->extent_ = (span + (std::size_t) this->step_ - 1) /
+                    (std::size_t) this->step_;
+            }
+        }
+
+        std::size_t extent(void) const
+        {
+            return this->extent_;
+        }
+
+        // computes the ordinal of an index, if it's within the range
+        bool operator()(const chare_index_t& view, std::size_t& ord) const
+        {
+            auto& idx = index_view<Index>::decode(view);
+            if (idx < this->start_)
+            {
+                return false;
+            }
+            auto offset = (std::size_t)(idx - this->start_);
+            auto step = (std::size_t) this->step_;
+            ord = offset / step;
+            return ((offset % step) == 0) && (ord < this->extent_);
+        }
+    };
+
+    // stores a collection's local elements, directly indexing them when
+    // the collection was seeded with a bounded range (falling back to a
+    // hash map for elements inserted outside of that range). only this
+    // pe's share of the range gets a slot, i.e., the seeds' ordinals have
+    // to be evenly spaced (as with block or round-robin mappings)
+    template <typename T, typename Index>
+    class element_table_
+    {
+        using ordinal_type = dense_ordinal_<Index>;
+        // one-based offsets into elements_ (with zero meaning "absent")
+        using slot_type = std::uint32_t;
+
+        ordinal_type ordinal_;
+        // the ordinal of our first seed, and the spacing of the rest
+        std::size_t first_;
+        std::size_t stride_;
+        std::vector<slot_type> slots_;
+        std::vector<chare_ptr_<T>> elements_;
+        chare_flat_map_<chare_ptr_<T>> sparse_;
+
+    public:
+        element_table_(const collection_options<Index>& opts)
+          : ordinal_(opts)
+          , first_(0)
+          , stride_(1)
+        {
+        }
+
+        // sizes the slots to fit this pe's seeds (in ascending order),
+        // which are left sparse when they're unevenly spaced
+        void lay_out(const std::vector<chare_index_t>& seeds)
+        {
+            std::size_t first, next;
+            if (!ordinal_type::value || seeds.empty() ||
+                !this->ordinal_(seeds.front(), first))
+            {
+                return;
+            }
+            std::size_t stride = 1;
+            if (seeds.size() > 1)
+            {
+                if (!this->ordinal_(seeds[1], next) || (next <= first))
+                {
+                    return;
+                }
+                stride = next - first;
+            }
+            for (std::size_t i = 2; i < seeds.size(); i++)
+            {
+                if (!this->ordinal_(seeds[i], next) ||
+                    (next != (first + i * stride)))
+                {
+                    return;
+                }
+            }
+            CmiEnforceMsg(
+                seeds.size() < std::numeric_limits<slot_type>::max(),
+                "collection too large for dense storage");
+            this->first_ = first;
+            this->stride_ = stride;
+            this->slots_.assign(seeds.size(), 0);
+        }
+
+        bool is_dense(void) const
+        {
+            return !(this->slots_.empty());
+        }
+
+        T* find(const chare_index_t& idx) const
+        {
+            std::size_t ord;
+            if (this->local_ordinal_(idx, ord))
+            {
+                auto slot = this->slots_[ord];
+                return slot ? this->elements_[slot - 1].get() : nullptr;
+            }
+            else
+            {
+                auto find = this->sparse_.find(idx);
+                return (find == std::end(this->sparse_)) ? nullptr :
+                                                           (find->second).get();
+            }
+        }
+
+        // takes ownership of obj, returning false if idx is occupied
+        bool emplace(const chare_index_t& idx, T* obj)
+        {
+            chare_ptr_<T> owned(obj);
+            std::size_t ord;
+            if (this->local_ordinal_(idx, ord))
+            {
+                auto& slot = this->slots_[ord];
+                if (slot)
+                {
+                    owned.release();
+                    return false;
+                }
+                this->elements_.emplace_back(std::move(owned));
+                slot = (slot_type) this->elements_.size();
+                return true;
+            }
+            else
+            {
+                auto ins = this->sparse_.emplace(idx, std::move(owned));
+                if (!ins.second)
+                {
+                    owned.release();
+                }
+                return ins.second;
+            }
+        }
+
+        std::size_t size(void) const
+        {
+            return this->elements_.size() + this->sparse_.size();
+        }
+
+        // invokes fn on each local element (dense ones first, in
+        // order of creation)
+        template <typename Fn>
+        void for_each(const Fn& fn) const
+        {
+            for (auto& elt : this->elements_)
+            {
+                fn(elt.get());
+            }
+            for (auto& pair : this->sparse_)
+            {
+                fn((pair.second).get());
+            }
+        }
+
+    private:
+        // computes the slot of an index, if it's one of our seeds'
+        bool local_ordinal_(const chare_index_t& idx, std::size_t& ord) const
+        {
+            if (!this->is_dense() || !this->ordinal_(idx, ord) ||
+                (ord < this->first_))
+            {
+                return false;
+            }
+            auto offset = ord - this->first_;
+            ord = offset / this->stride_;
+            return ((offset % this->stride_) == 0) &&
+                (ord < this->slots_.size());
+        }
+    };
+}    // namespace cmk
+
+#endif
@@ -0,0 +1,185 @@
+#ifndef __CMK_TREE_HH__
+#define __CMK_TREE_HH__
+
+#include <algorithm>
+
+#include "common.hh"
+
+namespace cmk {
+    enum tree_kind : std::uint8_t
+    {
+        kKaryTree = 0,
+        kBinomialTree,
+        // fans out to one pe per physical node, then within each node
+        kNodeAwareTree
+    };
+
+    // selects the shape of a collection's spanning tree
+    struct tree_shape
+    {
+        static constexpr std::uint8_t default_arity = 4;
+
+        tree_kind kind;
+        // the branching factor of k-ary (and node-aware) trees
+        std::uint8_t arity;
+
+        static tree_shape kary(std::uint8_t k = default_arity)
+        {
+            CmiEnforceMsg(k > 0, "trees must have a branching factor");
+            return tree_shape{kKaryTree, k};
+        }
+
+        static tree_shape binomial(void)
+        {
+            return tree_shape{kBinomialTree, 0};
+        }
+
+        static tree_shape node_aware(std::uint8_t k = default_arity)
+        {
+            CmiEnforceMsg(k > 0, "trees must have a branching factor");
+            return tree_shape{kNodeAwareTree, k};
+        }
+    };
+
+    // parent and children (by position) in a k-ary tree of n members
+    inline int kary_parent_(int k, int i)
+    {
+        return (i == 0) ? -1 : ((i - 1) / k);
+    }
+
+    template <typename Fn>
+    inline void kary_children_(int k, int n, int i, const Fn& fn)
+    {
+        auto first = k * i + 1;
+        auto last = std::min(first + k, n);
+        for (auto child = first; child < last; child++)
+        {
+            fn(child);
+        }
+    }
+
+    // finds a pe's parent (or -1) and children within a tree spanning pes,
+    // rooted at pes.front(). these are only computed when a collection's
+    // membership changes, so they favor simplicity over speed.
+    inline void build_tree_(const tree_shape& shape,
+        const std::vector<int>& pes, int pe, int& parent,
+        std::vector<int>& children)
+    {
+        auto n = (int) pes.size();
+        auto rank = (int) (std::find(std::begin(pes), std::end(pes), pe) -
+            std::begin(pes));
+        CmiAssertMsg(rank < n, "pe is not a member of the tree");
+        auto add_child = [&](int child) {
+            children.emplace_back(pes[child]);
+        };
+        switch (shape.kind)
+        {
+        case kKaryTree:
+        {
+            auto up = kary_parent_(shape.arity, rank);
+            parent = (up >= 0) ? pes[up] : -1;
+            kary_children_(shape.arity, n, rank, add_child);
+            break;
+        }
+        case kBinomialTree:
+        {
+            // a rank's parent clears its lowest set bit, so its children
+            // set each bit below that one
+            parent = (rank == 0) ? -1 : pes[rank & (rank - 1)];
+            auto low = (rank == 0) ? n : (rank & -rank);
+            for (auto bit = 1; (bit < low) && ((rank + bit) < n); bit *= 2)
+            {
+                add_child(rank + bit);
+            }
+            break;
+        }
+        case kNodeAwareTree:
+        {
+            // group the pes by physical node (in order of appearance)
+            std::vector<std::vector<int>> nodes;
+            std::vector<int> ids;
+            for (auto& member : pes)
+            {
+                auto id = CmiPhysicalNodeID(member);
+                auto pos = std::find(std::begin(ids), std::end(ids), id);
+                if (pos == std::end(ids))
+                {
+                    ids.emplace_back(id);
+                    nodes.emplace_back();
+                    pos = std::end(ids) - 1;
+                }
+                nodes[pos - std::begin(ids)].emplace_back(member);
+            }
+            auto k = (int) shape.arity;
+            auto n_nodes = (int) nodes.size();
+            auto id = CmiPhysicalNodeID(pe);
+            auto node = (int) (std::find(std::begin(ids), std::end(ids), id) -
+                std::begin(ids));
+            auto& local = nodes[node];
+            auto it = std::find(std::begin(local), std::end(local), pe);
+            auto pos = (int) (it - std::begin(local));
+            if (pos == 0)
+            {
+                // node leaders form a tree amongst themselves
+                auto up = kary_parent_(k, node);
+                parent = (up >= 0) ? nodes[up].front() : -1;
+                kary_children_(k, n_nodes, node, [&](int child) {
+                    children.emplace_back(nodes[child].front());
+                });
+            }
+            else
+            {
+                parent = local[kary_parent_(k, pos)];
+            }
+            // then fan out within their node
+            kary_children_(k, (int) local.size(), pos, [&](int child) {
+                children.emplace_back(local[child]);
+            });
+            break;
+        }
+        default:
+            CmiAbort("unknown tree kind");
+        }
+    }
+
+    // a pe's view of the tree that reductions take between (logical)
+    // nodes. the pes of each node share an accumulator, expecting one
+    // partial from each of its member pes and each of its child nodes
+    struct node_tree_
+    {
+        std::size_t expected;
+        // the pe hosting the parent node's accumulator (or -1)
+        int parent;
+    };
+
+    inline node_tree_ build_node_tree_(
+        const tree_shape& shape, const std::vector<int>& pes, int pe)
+    {
+        // the first member of each node represents it in the tree
+        std::vector<int> leaders;
+        std::size_t n_local = 0;
+        for (auto& member : pes)
+        {
+            auto node = CmiNodeOf(member);
+            auto pos = std::find_if(std::begin(leaders), std::end(leaders),
+                [&](int leader) { return CmiNodeOf(leader) == node; });
+            if (pos == std::end(leaders))
+            {
+                leaders.emplace_back(member);
+            }
+            if (node == CmiNodeOf(pe))
+            {
+                n_local++;
+            }
+        }
+        CmiAssertMsg(n_local > 0, "pe is not a member of the tree");
+        auto leader = *std::find_if(std::begin(leaders), std::end(leaders),
+            [&](int other) { return CmiNodeOf(other) == CmiNodeOf(pe); });
+        int parent;
+        std::vector<int> children;
+        build_tree_(shape, leaders, leader, parent, children);
+        return node_tree_{n_local + children.size(), parent};
+    }
+}    // namespace cmk
+
+#endif
@@ -1,12 +1,18 @@
 #include "core.hh"
 
+#include "aggregator.hh"
+#include "buffer.hh"
 #include "collection.hh"
 #include "proxy.hh"
+#include "quiescence.hh"
+#include "reduction.hh"
 
 namespace cmk {
     // these can be nix'd when we upgrade to c++17
     constexpr int default_options<int>::start;
     constexpr int default_options<int>::step;
+    constexpr std::size_t message_pool::default_capacity_;
+    constexpr std::size_t chare_slab_::max_block_;
 
     CsvDeclare(entry_table_t, entry_table_);
     CsvDeclare(chare_table_t, chare_table_);
@@ -14,11 +20,23 @@ namespace cmk {
     CsvDeclare(callback_table_t, callback_table_);
     CsvDeclare(combiner_table_t, combiner_table_);
     CsvDeclare(collection_kinds_t, collection_kinds_);
+    CsvDeclare(node_reducer_table_t, node_reducers_);
+    CsvDeclare(CmiNodeLock, node_reducers_lock_);
 
     CpvDeclare(collection_table_t, collection_table_);
     CpvDeclare(collection_buffer_t, collection_buffer_);
     CpvDeclare(std::uint32_t, local_collection_count_);
     CpvDeclare(int, converse_handler_);
+    CpvDeclare(std::size_t, inline_depth_);
+    CpvDeclare(message_pool, message_pool_);
+    CpvDeclare(chare_slab_table_t, chare_slabs_);
+    CpvDeclare(pe_reducer_, pe_reducer_);
+    CpvDeclare(std::size_t, segment_size_);
+    CpvDeclare(segment_table_t, segment_table_);
+    CpvDeclare(qd_counters_, qd_counters_);
+    CpvDeclare(quiescence_detector_, quiescence_detector_);
+    CpvDeclare(aggregator_, aggregator_);
+    CpvDeclare(int, buffer_release_handler_);
 
     void initialize_globals_(void)
     {
@@ -30,15 +48,36 @@ namespace cmk {
             CsvInitialize(callback_table_t, callback_table_);
             CsvInitialize(combiner_table_t, combiner_table_);
             CsvInitialize(collection_kinds_t, collection_kinds_);
+            CsvInitialize(node_reducer_table_t, node_reducers_);
+            CsvInitialize(CmiNodeLock, node_reducers_lock_);
+            CsvAccess(node_reducers_lock_) = CmiCreateLock();
         }
         CpvInitialize(collection_table_t, collection_table_);
         CpvInitialize(collection_buffer_t, collection_buffer_);
+        CpvInitialize(message_pool, message_pool_);
+        CpvInitialize(chare_slab_table_t, chare_slabs_);
+        CpvInitialize(pe_reducer_, pe_reducer_);
+        CpvInitialize(segment_table_t, segment_table_);
+        CpvInitialize(std::size_t, segment_size_);
+        CpvAccess(segment_size_) = CHARMLITE_SEGMENT_SIZE;
+        CpvInitialize(qd_counters_, qd_counters_);
+        CpvInitialize(quiescence_detector_, quiescence_detector_);
+        CpvInitialize(aggregator_, aggregator_);
         // collection ids start after zero
         CpvInitialize(std::uint32_t, local_collection_count_);
         CpvAccess(local_collection_count_) = 0;
+        // no inline deliveries are in progress
+        CpvInitialize(std::size_t, inline_depth_);
+        CpvAccess(inline_depth_) = 0;
         // register converse handlers
         CpvInitialize(int, converse_handler_);
         CpvAccess(converse_handler_) = CmiRegisterHandler(converse_handler_);
+        CpvAccess(quiescence_detector_).initialize();
+        CpvAccess(aggregator_).initialize();
+        CpvInitialize(int, buffer_release_handler_);
+        CpvAccess(buffer_release_handler_) =
+            CmiRegisterHandler(buffer_release_handler_);
+        CmiSetDirectNcpyAckHandler(buffer_ncpy_handler_);
     }
 
     void start_fn_(int, char** argv)
@@ -108,7 +147,10 @@ namespace cmk {
             }
             else
             {
-                auto& buffer = find->second;
+                // take ownership of the buffer since delivery may
+                // insert into (and rehash) the table
+                auto buffer = std::move(find->second);
+                buf.erase(find);
                 while (!buffer.empty())
                 {
                     obj->deliver(std::move(buffer.front()), immediate);
@@ -142,9 +184,66 @@ namespace cmk {
         (callback_for(msg))(std::move(msg));
     }
 
+    void qd_handler_(void* raw)
+    {
+        CpvAccess(quiescence_detector_).handle(static_cast<qd_message_*>(raw));
+    }
+
+    // unpacks a buffer of aggregated messages, delivering each in turn
+    void aggregate_handler_(void* raw)
+    {
+        auto* buf = static_cast<aggregate_message_*>(raw);
+        buf->for_each([](message_ptr<>&& msg) {
+            count_processed_(msg->dst_);
+            deliver_to_endpoint_(std::move(msg), true);
+        });
+        CmiFree(buf);
+    }
+
+    void aggregate_flush_handler_(void* raw)
+    {
+        CpvAccess(aggregator_).handle_flush(raw);
+    }
+
+    void buffer_release_handler_(void* raw)
+    {
+        destination none;
+        count_processed_(none);
+        buffer_released_(static_cast<buffer_release_message_*>(raw));
+        CmiFree(raw);
+    }
+
+    void buffer_ncpy_handler_(void* raw)
+    {
+        buffer_ncpy_ack_(static_cast<NcpyOperationInfo*>(raw));
+    }
+
     void converse_handler_(void* raw)
     {
         message_ptr<> msg(static_cast<message*>(raw));
+        // prioritized messages are requeued by their priority on arrival
+        // (then handled once the scheduler gets back to them)
+        if (msg->has_priority() && !msg->is_enqueued())
+        {
+            auto& prio = *(msg->prio());
+            msg->is_enqueued() = true;
+            CsdEnqueueGeneral(
+                msg.get(), prio.queueing, prio.nbits, prio.words.data());
+            msg.release();
+            return;
+        }
+        // ( in case it's forwarded )
+        msg->is_enqueued() = false;
+        count_processed_(msg->dst_);
+        // reassemble the results of segmented reductions
+        if (msg->is_segment() && !msg->has_combiner())
+        {
+            msg = join_segment_(std::move(msg));
+            if (!msg)
+            {
+                return;
+            }
+        }
         // then determine how to route it
         switch (msg->dst_.kind())
         {
@@ -152,7 +251,15 @@ namespace cmk {
             deliver_to_endpoint_(std::move(msg), true);
             break;
         case kCallback:
-            deliver_to_callback_(std::move(msg));
+            // callbacks with combiners are partials of pe-level reductions
+            if (msg->has_combiner())
+            {
+                CpvAccess(pe_reducer_).accept(std::move(msg));
+            }
+            else
+            {
+                deliver_to_callback_(std::move(msg));
+            }
             break;
         default:
             CmiAbort("invalid message destination");
@@ -171,9 +278,26 @@ namespace cmk {
             break;
         }
         case kEndpoint:
+        {
             CmiAssert(!msg->has_collection_kind());
-            deliver_to_endpoint_(std::move(msg), false);
+            auto& depth = CpvAccess(inline_depth_);
+            // inline messages are delivered immediately (unless we're too
+            // deeply nested, then they're queued to bound our stack usage)
+            auto immediate =
+                msg->is_inline() && (depth < CHARMLITE_MAX_INLINE_DEPTH);
+            msg->is_inline() = false;
+            if (immediate)
+            {
+                depth++;
+                deliver_to_endpoint_(std::move(msg), true);
+                depth--;
+            }
+            else
+            {
+                deliver_to_endpoint_(std::move(msg), false);
+            }
             break;
+        }
         default:
             CmiAbort("invalid message destination");
         }